@@ -0,0 +1,41 @@
+#include "AllocationCounter.h"
+
+#include "SDL_atomic.h"
+
+#ifdef SNOWSHOOTER_COUNT_ALLOCATIONS
+#include <cstdlib>
+#include <new>
+
+namespace {
+SDL_atomic_t allocations{};
+}  // namespace
+
+void* operator new(const std::size_t size) {
+  SDL_AtomicAdd(&allocations, 1);
+  auto* memory = std::malloc(size != 0 ? size : 1);
+  if (memory == nullptr) throw std::bad_alloc();
+  return memory;
+}
+
+void* operator new[](const std::size_t size) { return operator new(size); }
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+
+void operator delete[](void* memory) noexcept { std::free(memory); }
+
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+
+void operator delete[](void* memory, std::size_t) noexcept {
+  std::free(memory);
+}
+
+bool AllocationCounter::isEnabled() { return true; }
+
+Uint32 AllocationCounter::getCount() {
+  return static_cast<Uint32>(SDL_AtomicGet(&allocations));
+}
+#else
+bool AllocationCounter::isEnabled() { return false; }
+
+Uint32 AllocationCounter::getCount() { return 0; }
+#endif
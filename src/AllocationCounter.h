@@ -0,0 +1,21 @@
+#pragma once
+#include "SDL.h"
+
+/**
+ * \brief The AllocationCounter utility that counts every heap allocation made
+ * through operator new, to check the frame loop does not allocate once it is
+ * warmed up. Counting replaces the global operator new, so it is only built
+ * into debug builds, or when SNOWSHOOTER_COUNT_ALLOCATIONS is defined.
+ */
+class AllocationCounter final {
+ public:
+  /**
+   * \return Whether or not allocations are being counted in this build.
+   */
+  static bool isEnabled();
+
+  /**
+   * \return The amount of allocations made so far, always 0 when disabled.
+   */
+  static Uint32 getCount();
+};
@@ -0,0 +1,37 @@
+#include "Camera.h"
+
+#include "Constants.h"
+
+Camera::Camera() : position_(0, 0), size_(WIN_WIDTH, WIN_HEIGHT) {}
+
+void Camera::setPosition(const Vector2D<int>& position) {
+  position_ = position;
+}
+
+Vector2D<int> Camera::getPosition() const { return position_; }
+
+void Camera::setSize(const Vector2D<int>& size) { size_ = size; }
+
+Vector2D<int> Camera::getSize() const { return size_; }
+
+void Camera::centerOn(const Vector2D<int>& position) {
+  position_.set(position.getX() - size_.getX() / 2,
+                position.getY() - size_.getY() / 2);
+}
+
+SDL_Rect Camera::getViewport() const {
+  return {position_.getX(), position_.getY(), size_.getX(), size_.getY()};
+}
+
+bool Camera::isVisible(const SDL_Rect& rect) const {
+  const auto viewport = getViewport();
+  return SDL_HasIntersection(&viewport, &rect) == SDL_TRUE;
+}
+
+SDL_Rect Camera::toScreen(const SDL_Rect& rect) const {
+  return {rect.x - position_.getX(), rect.y - position_.getY(), rect.w, rect.h};
+}
+
+SDL_Point Camera::toWorld(const SDL_Point& point) const {
+  return {point.x + position_.getX(), point.y + position_.getY()};
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "SDL.h"
+#include "Vector2D.h"
+
+/**
+ * \brief The Camera class that maps the scene's world coordinates to the
+ * screen. It starts as the window placed at the origin, so scenes that never
+ * move it draw exactly where their objects are.
+ */
+class Camera final {
+  /**
+   * \brief The world position of the view's top left corner.
+   */
+  Vector2D<int> position_;
+  Vector2D<int> size_;
+
+ public:
+  Camera();
+
+  void setPosition(const Vector2D<int>& position);
+  Vector2D<int> getPosition() const;
+
+  void setSize(const Vector2D<int>& size);
+  Vector2D<int> getSize() const;
+
+  /**
+   * \brief Moves the view so a world position is at its center.
+   */
+  void centerOn(const Vector2D<int>& position);
+
+  /**
+   * \return The area of the world in view.
+   */
+  SDL_Rect getViewport() const;
+
+  /**
+   * \return Whether or not any part of a world rectangle is in view.
+   */
+  bool isVisible(const SDL_Rect& rect) const;
+
+  /**
+   * \return The world rectangle in screen coordinates.
+   */
+  SDL_Rect toScreen(const SDL_Rect& rect) const;
+
+  /**
+   * \return The screen point in world coordinates.
+   */
+  SDL_Point toWorld(const SDL_Point& point) const;
+};
@@ -1,5 +1,9 @@
 #include "Client.h"
 
+#include "Clock.h"
+#include "Constants.h"
+#include "Protocol.h"
+
 Client* Client::instance_ = nullptr;
 
 Client::Client() {
@@ -14,7 +18,7 @@ Client::Client() {
   }
 
   printf("Starting client...\n");
-  if (SDLNet_ResolveHost(&ip_, "localhost", 9999) == -1) {
+  if (SDLNet_ResolveHost(&ip_, "localhost", SERVER_PORT) == -1) {
     printf("SDLNet_ResolveHost: %s\n", SDLNet_GetError());
     exit(1);
   }
@@ -24,10 +28,17 @@ Client::Client() {
     printf("SDLNet_TCP_Open: %s\n", SDLNet_GetError());
     exit(2);
   }
+
+  // Wait on a socket set, so the worker can wake up to send pings
+  socketSet_ = SDLNet_AllocSocketSet(1);
+  SDLNet_TCP_AddSocket(socketSet_, socket_);
+  send_mutex_ = SDL_CreateMutex();
 }
 
 Client::~Client() {
+  if (socketSet_ != nullptr) SDLNet_FreeSocketSet(socketSet_);
   if (socket_ != nullptr) SDLNet_TCP_Close(socket_);
+  if (send_mutex_ != nullptr) SDL_DestroyMutex(send_mutex_);
 
   SDLNet_Quit();
   SDL_Quit();
@@ -37,19 +48,77 @@ void Client::initializeThread() {
   auto instance = getInstance();
   instance->resume();
 
+  auto nextPing = Clock::milliseconds();
   while (instance->isRunning()) {
-    char message[1024];
-    if (SDLNet_TCP_Recv(instance->socket_, message, 1024) == 0) {
+    const auto now = Clock::milliseconds();
+    if (now >= nextPing) {
+      instance->sendPing();
+
+      // Ping in a quick burst until the clock is synchronized
+      nextPing = now + (instance->clock_.isSynchronized()
+                            ? NETWORK_PING_INTERVAL
+                            : NETWORK_SYNC_INTERVAL);
+    }
+
+    if (SDLNet_CheckSockets(instance->socketSet_, NETWORK_POLL_INTERVAL) <= 0 ||
+        !SDLNet_SocketReady(instance->socket_))
+      continue;
+
+    char buffer[1024];
+    const auto length =
+        SDLNet_TCP_Recv(instance->socket_, buffer, sizeof buffer);
+    if (length <= 0) {
       instance->stop();
       break;
     }
 
-    printf("Received: %s\n", message);
+    instance->stats_.addReceived(static_cast<Uint64>(length));
+
+    // Split the stream into messages, keeping any incomplete one for later
+    auto& incoming = instance->incoming_;
+    incoming.append(buffer, static_cast<size_t>(length));
+    size_t start = 0;
+    size_t end;
+    while ((end = incoming.find(Protocol::MESSAGE_END, start)) !=
+           std::string::npos) {
+      incoming[end] = '\0';
+      instance->handleMessage(&incoming[start], static_cast<int>(end - start));
+      start = end + 1;
+    }
+    incoming.erase(0, start);
+  }
+}
+
+void Client::handleMessage(char* message, const int length) {
+  if (length <= 0) return;
+  if (handleControl(message, length)) return;
+  if (handleLockstep(message, length)) return;
 
-    const auto* payload = parseContent(message);
-    if (payload == nullptr) continue;
-    instance->pushEvent(*payload);
+  // Only the newest world state matters, so it skips the event queue
+  if (message[0] - 'a' == PLAYERS_SYNC) {
+    auto& state = world_.getWriteBuffer();
+    if (parseWorldState(message, static_cast<size_t>(length), state)) {
+      state.sequence = worldSequence_++;
+      world_.publish();
+    }
+    return;
   }
+
+  printf("Received: %s\n", message);
+
+  const auto* payload = parseContent(message);
+  if (payload == nullptr) return;
+
+  // A lockstep match starts right away, as the inputs may arrive before the
+  // game loop polls this event
+  if (payload->type_ == GAME_READY) {
+    const auto* ready = static_cast<const ClientEventGameReady*>(payload);
+    if (ready->lockstep_) lockstep_.start(ready->slot_, ready->peers_);
+  } else if (payload->type_ == GAME_END) {
+    lockstep_.stop();
+  }
+
+  pushEvent(*payload);
 }
 
 Client::ClientEventBase* Client::parseContent(char* message) {
@@ -65,8 +134,15 @@ Client::ClientEventBase* Client::parseContent(char* message) {
       return new ClientEventGameAvailable();
     case GAME_UNAVAILABLE:
       return new ClientEventGameUnavailable();
-    case GAME_READY:
-      return new ClientEventGameReady();
+    case GAME_READY: {
+      if (length < 4 || message[1] != 'l') {
+        return new ClientEventGameReady(false, 0, 0);
+      }
+
+      const auto slot = static_cast<uint8_t>(message[2] - '0');
+      const auto peers = static_cast<uint8_t>(message[3] - '0');
+      return new ClientEventGameReady(true, slot, peers);
+    }
     case GAME_END:
       return new ClientEventGameEnd();
     case ASK_NAME: {
@@ -100,37 +176,14 @@ Client::ClientEventBase* Client::parseContent(char* message) {
       const auto id = static_cast<uint8_t>(message[1] - '0');
       return new ClientEventGamePlayerRevive(id);
     }
-    case PLAYERS_SYNC: {
-      const auto count = (length - 1) / 17;
-      std::vector<ClientEventGamePlayerSync::player_t> players(count);
-      size_t offset = 1;
-      for (size_t i = 0; i < count; ++i) {
-        const auto id = static_cast<uint8_t>(message[offset] - '0');
-        std::string rawX(message + offset, 4);
-        std::string rawY(message + (offset + 4), 4);
-        std::string rawDirection(message + (offset + 8), 4);
-        std::string rawSpeed(message + (offset + 12), 4);
-        const auto x =
-            static_cast<float>(strtol(rawX.c_str(), nullptr, 10)) / 10.0f;
-        const auto y =
-            static_cast<float>(strtol(rawY.c_str(), nullptr, 10)) / 10.0f;
-        const auto direction =
-            static_cast<float>(strtol(rawDirection.c_str(), nullptr, 10)) /
-            10.0f;
-        const auto speed =
-            static_cast<float>(strtol(rawSpeed.c_str(), nullptr, 10)) / 10.0f;
-        players[i] = {id, x, y, direction, speed};
-        offset += 17;
-      }
-
-      return new ClientEventGamePlayerSync(players);
-    }
     case SHOT_CREATE: {
-      std::string rawID(message + 1, 4);
-      std::string rawX(message + 5, 4);
-      std::string rawY(message + 9, 4);
-      std::string rawDirection(message + 13, 4);
-      const auto shooter = static_cast<uint8_t>(message[17] - '0');
+      if (length < 34) return nullptr;
+      const auto time = Protocol::readTimestamp(message, 1);
+      std::string rawID(message + 17, 4);
+      std::string rawX(message + 21, 4);
+      std::string rawY(message + 25, 4);
+      std::string rawDirection(message + 29, 4);
+      const auto shooter = static_cast<uint8_t>(message[33] - '0');
       const auto id = static_cast<uint32_t>(strtol(rawID.c_str(), nullptr, 10));
       const auto x =
           static_cast<float>(strtol(rawX.c_str(), nullptr, 10)) / 10.0f;
@@ -138,19 +191,56 @@ Client::ClientEventBase* Client::parseContent(char* message) {
           static_cast<float>(strtol(rawY.c_str(), nullptr, 10)) / 10.0f;
       const auto direction =
           static_cast<float>(strtol(rawDirection.c_str(), nullptr, 10)) / 10.0f;
-      return new ClientEventGameShotCreate(id, x, y, direction, shooter);
+      return new ClientEventGameShotCreate(time, id, x, y, direction, shooter);
     }
     case SHOT_DESTROY: {
       std::string rawID(message + 1, 4);
       const auto id = static_cast<uint32_t>(strtol(rawID.c_str(), nullptr, 10));
       return new ClientEventGameShotDestroy(id);
     }
+    case PLAYERS_SYNC:
+    case PING:
+    case PONG:
+    case INPUT_FRAME:
+    case QUIT:
+    case CHECKSUM:
+    case DESYNC:
     case INVALID:
       break;
   }
   return nullptr;
 }
 
+bool Client::parseWorldState(const char* message, const size_t length,
+                             Client::world_state_t& state) {
+  if (length < 1 + Protocol::TIMESTAMP_LENGTH) return false;
+
+  state.time = Protocol::readTimestamp(message, 1);
+  state.players.clear();
+
+  const auto count = (length - 1 - Protocol::TIMESTAMP_LENGTH) / 17;
+  size_t offset = 1 + Protocol::TIMESTAMP_LENGTH;
+  for (size_t i = 0; i < count; ++i) {
+    const auto id = static_cast<uint8_t>(message[offset] - '0');
+    std::string rawX(message + (offset + 1), 4);
+    std::string rawY(message + (offset + 5), 4);
+    std::string rawDirection(message + (offset + 9), 4);
+    std::string rawSpeed(message + (offset + 13), 4);
+    const auto x =
+        static_cast<float>(strtol(rawX.c_str(), nullptr, 10)) / 10.0f;
+    const auto y =
+        static_cast<float>(strtol(rawY.c_str(), nullptr, 10)) / 10.0f;
+    const auto direction =
+        static_cast<float>(strtol(rawDirection.c_str(), nullptr, 10)) / 10.0f;
+    const auto speed =
+        static_cast<float>(strtol(rawSpeed.c_str(), nullptr, 10)) / 10.0f;
+    state.players.push_back({id, x, y, direction, speed});
+    offset += 17;
+  }
+
+  return true;
+}
+
 void Client::run() {
   auto* thread = SDL_CreateThread(
       reinterpret_cast<SDL_ThreadFunction>(Client::initializeThread),
@@ -159,9 +249,13 @@ void Client::run() {
 }
 
 int Client::clientPollEvent(Client::ClientEventBase* event) {
-  if (SDL_LockMutex(getMutex())) {
-    if (events_.empty()) return 0;
-    *event = events_.front();
+  if (SDL_LockMutex(getMutex()) == 0) {
+    if (events_.empty()) {
+      SDL_UnlockMutex(event_mutex_);
+      return 0;
+    }
+
+    if (event != nullptr) *event = events_.front();
     events_.pop();
 
     SDL_UnlockMutex(event_mutex_);
@@ -172,13 +266,152 @@ int Client::clientPollEvent(Client::ClientEventBase* event) {
   return 0;
 }
 
+const Client::world_state_t* Client::pollWorldState() {
+  if (!world_.update()) return nullptr;
+  return &world_.getReadBuffer();
+}
+
+int Client::send(const char* message, const int length) {
+  if (SDL_LockMutex(send_mutex_) != 0) {
+    fprintf(stderr, "Couldn't lock mutex: %s", SDL_GetError());
+    return 0;
+  }
+
+  // Written at once, so the terminator never travels in a separate packet
+  outgoing_.assign(message, static_cast<size_t>(length));
+  outgoing_ += Protocol::MESSAGE_END;
+  const auto sent = SDLNet_TCP_Send(socket_, outgoing_.data(),
+                                    static_cast<int>(outgoing_.size()));
+  SDL_UnlockMutex(send_mutex_);
+
+  if (sent > 0) stats_.addSent(static_cast<Uint64>(sent));
+  return sent;
+}
+
+void Client::sendPing() {
+  char ping[Protocol::PING_LENGTH];
+  ping[0] = static_cast<char>(PING + 'a');
+  Protocol::writeTimestamp(ping, Clock::microseconds(), 1);
+  send(ping, sizeof ping);
+}
+
+bool Client::handleControl(const char* message, const int length) {
+  const auto now = Clock::microseconds();
+  const auto type = static_cast<int>(message[0] - 'a');
+  if (type == PING && length >= Protocol::PING_LENGTH) {
+    char pong[Protocol::PONG_LENGTH];
+    pong[0] = static_cast<char>(PONG + 'a');
+    memcpy(pong + 1, message + 1, Protocol::TIMESTAMP_LENGTH);
+    Protocol::writeTimestamp(pong, now, 1 + Protocol::TIMESTAMP_LENGTH);
+    Protocol::writeTimestamp(pong, Clock::microseconds(),
+                             1 + 2 * Protocol::TIMESTAMP_LENGTH);
+    send(pong, sizeof pong);
+    return true;
+  }
+
+  if (type == PONG && length >= Protocol::PONG_LENGTH) {
+    const auto sent = Protocol::readTimestamp(message, 1);
+    const auto received =
+        Protocol::readTimestamp(message, 1 + Protocol::TIMESTAMP_LENGTH);
+    const auto replied =
+        Protocol::readTimestamp(message, 1 + 2 * Protocol::TIMESTAMP_LENGTH);
+    if (now < sent || replied < received) return true;
+
+    // Exclude the time the peer took to reply from the round trip
+    const auto elapsed = now - sent;
+    const auto processing = replied - received;
+    if (elapsed >= processing) stats_.addRoundTrip(elapsed - processing);
+    clock_.addSample(sent, received, replied, now);
+    return true;
+  }
+
+  return false;
+}
+
+bool Client::handleLockstep(const char* message, const int length) {
+  const auto type = static_cast<int>(message[0] - 'a');
+  if (type == INPUT_FRAME && length >= Protocol::INPUT_FRAME_LENGTH + 1) {
+    const auto frame = static_cast<Uint32>(
+        Protocol::readNumber(message, 1, Protocol::FRAME_LENGTH));
+    size_t offset = 1 + Protocol::FRAME_LENGTH;
+    const auto buttons =
+        static_cast<Uint8>(Protocol::readNumber(message, offset, 2, true));
+    const auto aim =
+        static_cast<Uint16>(Protocol::readNumber(message, offset + 2, 4, true));
+    const auto peer =
+        static_cast<Uint8>(message[Protocol::INPUT_FRAME_LENGTH] - '0');
+    lockstep_.receive(frame, peer, {buttons, aim});
+    return true;
+  }
+
+  if (type == DESYNC && length >= Protocol::DESYNC_LENGTH) {
+    const auto frame = static_cast<Uint32>(
+        Protocol::readNumber(message, 1, Protocol::FRAME_LENGTH));
+    printf("Lockstep desync at frame %u\n", frame);
+    lockstep_.desync(frame);
+    return true;
+  }
+
+  return type == INPUT_FRAME || type == CHECKSUM || type == DESYNC;
+}
+
+LockstepSession& Client::getLockstep() { return lockstep_; }
+
+bool Client::sendInput(const LockstepSession::input_t& input) {
+  Uint32 frame;
+  if (!lockstep_.submit(input, frame)) return false;
+
+  char message[Protocol::INPUT_FRAME_LENGTH];
+  message[0] = static_cast<char>(INPUT_FRAME + 'a');
+  Protocol::writeNumber(message, frame, 1, Protocol::FRAME_LENGTH);
+  Protocol::writeNumber(message, input.buttons, 1 + Protocol::FRAME_LENGTH, 2,
+                        true);
+  Protocol::writeNumber(message, input.aim, 3 + Protocol::FRAME_LENGTH, 4,
+                        true);
+  send(message, sizeof message);
+  return true;
+}
+
+void Client::sendChecksum(const Uint32 frame, const Uint32 checksum) {
+  char message[Protocol::CHECKSUM_MESSAGE_LENGTH];
+  message[0] = static_cast<char>(CHECKSUM + 'a');
+  Protocol::writeNumber(message, frame, 1, Protocol::FRAME_LENGTH);
+  Protocol::writeNumber(message, checksum, 1 + Protocol::FRAME_LENGTH,
+                        Protocol::CHECKSUM_LENGTH, true);
+  send(message, sizeof message);
+}
+
+bool Client::stepLockstep(const LockstepSession::input_t& input,
+                          const LockstepSession::simulate_t& simulate) {
+  if (!lockstep_.isActive() || lockstep_.isDesynced()) return false;
+
+  // Rejected while the inputs are already LOCKSTEP_INPUT_DELAY frames ahead
+  sendInput(input);
+
+  Uint32 frame;
+  LockstepSession::frame_inputs_t inputs;
+  if (!lockstep_.advance(frame, inputs)) return false;
+
+  const auto checksum = simulate(frame, inputs);
+  if (LockstepSession::isChecksumFrame(frame)) sendChecksum(frame, checksum);
+  return true;
+}
+
+const NetworkStats& Client::getStats() const { return stats_; }
+
+const ClockSync& Client::getClockSync() const { return clock_; }
+
+Uint64 Client::getServerTime() const {
+  return static_cast<Uint64>(clock_.toRemote(Clock::microseconds()));
+}
+
 SDL_mutex* Client::getMutex() {
   if (event_mutex_ == nullptr) event_mutex_ = SDL_CreateMutex();
   return event_mutex_;
 }
 
 void Client::pushEvent(const Client::ClientEventBase& event) {
-  if (SDL_LockMutex(getMutex())) {
+  if (SDL_LockMutex(getMutex()) == 0) {
     events_.push(event);
     SDL_UnlockMutex(event_mutex_);
   } else {
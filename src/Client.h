@@ -3,9 +3,14 @@
 #include <queue>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "ClockSync.h"
+#include "LockstepSession.h"
+#include "NetworkStats.h"
 #include "SDL_atomic.h"
 #include "SDL_net.h"
+#include "TripleBuffer.h"
 
 enum ClientEventDataType {
   /**
@@ -23,7 +28,8 @@ enum ClientEventDataType {
   /**
    * \brief Command sent via broadcast to all users announcing the game start.
    * \note Not to be confused with `ClientEventDataType::PLAYER_READY`.
-   * \payload nullptr.
+   * \payload The mode, 's' when the server streams the state, or 'l' for
+   * lockstep followed by the player's slot and the amount of players.
    */
   GAME_READY,
 
@@ -70,15 +76,17 @@ enum ClientEventDataType {
   PLAYER_REVIVE,
 
   /**
-   * \brief Command sent to joining players to add all the current players.
-   * \payload Players health, position, direction, speed, and name.
+   * \brief Command sent periodically to all players with the state of every
+   * player. It is not queued as an event, only the newest one is kept and
+   * read through `Client::pollWorldState`.
+   * \payload The server time, and the players position, direction, and speed.
    */
   PLAYERS_SYNC,
 
   /**
    * \brief Command sent via broadcast to all players to add a new bullet.
-   * \payload The bullet information, including the origin (player's shooter)
-   * and the direction.
+   * \payload The server time, and the bullet information, including the origin
+   * (player's shooter) and the direction.
    */
   SHOT_CREATE,
 
@@ -89,6 +97,48 @@ enum ClientEventDataType {
    */
   SHOT_DESTROY,
 
+  /**
+   * \brief Command sent periodically by both ends to measure the round-trip
+   * time. \payload The sender's timestamp.
+   */
+  PING,
+
+  /**
+   * \brief Command sent in reply to `ClientEventDataType::PING`.
+   * \payload The timestamp received in the ping, echoed back, followed by the
+   * responder's timestamps when the ping was received and the pong was sent.
+   */
+  PONG,
+
+  /**
+   * \brief Command sent by lockstep players with their input for a frame,
+   * which the server relays to everyone. It is not queued as an event, it is
+   * stored in the `LockstepSession`.
+   * \payload The frame and the input, followed by the player's slot when
+   * relayed.
+   */
+  INPUT_FRAME,
+
+  /**
+   * \brief Command sent by a client to the server to disconnect, written as
+   * `q`. It keeps its slot so no other command shares its code.
+   */
+  QUIT,
+
+  /**
+   * \brief Command sent by lockstep players with the checksum of their state
+   * after simulating a frame.
+   * \payload The frame and the checksum.
+   */
+  CHECKSUM,
+
+  /**
+   * \brief Command sent by the server to all lockstep players when their
+   * checksums disagree.
+   * \payload The first frame the checksums disagreed on.
+   */
+  DESYNC,
+
   /**
    * \brief Invalid code, used to check boundaries.
    */
@@ -96,10 +146,47 @@ enum ClientEventDataType {
 };
 
 class Client {
+ public:
+  typedef struct {
+    uint8_t id;
+    float x;
+    float y;
+    float direction;
+    float speed;
+  } player_state_t;
+
+  typedef struct {
+    /**
+     * \brief The server time the state was taken at, in microseconds.
+     */
+    Uint64 time;
+    /**
+     * \brief The amount of states received before this one, which tells how
+     * many were skipped since the last poll.
+     */
+    Uint32 sequence;
+    std::vector<player_state_t> players;
+  } world_state_t;
+
  private:
   SDL_atomic_t running_{};
   IPaddress ip_{};
   TCPsocket socket_;
+  SDLNet_SocketSet socketSet_ = nullptr;
+
+  /**
+   * \brief Guards the socket's writes, as lockstep inputs are sent from the
+   * game loop.
+   */
+  SDL_mutex* send_mutex_ = nullptr;
+  std::string outgoing_{};
+
+  /**
+   * \brief The bytes received after the last complete message.
+   */
+  std::string incoming_{};
+  NetworkStats stats_{};
+  ClockSync clock_{};
 
   class ClientEventBase {
    public:
@@ -117,7 +204,14 @@ class Client {
   };
   class ClientEventGameReady : public ClientEventBase {
    public:
-    ClientEventGameReady() : ClientEventBase(GAME_READY) {}
+    ClientEventGameReady(bool lockstep, uint8_t slot, uint8_t peers)
+        : ClientEventBase(GAME_READY),
+          lockstep_(lockstep),
+          slot_(slot),
+          peers_(peers) {}
+    bool lockstep_;
+    uint8_t slot_;
+    uint8_t peers_;
   };
   class ClientEventGameEnd : public ClientEventBase {
    public:
@@ -166,30 +260,18 @@ class Client {
         : ClientEventBase(PLAYER_REVIVE), id_(id) {}
     uint8_t id_;
   };
-  class ClientEventGamePlayerSync : public ClientEventBase {
-   public:
-    typedef struct {
-      uint8_t id;
-      float x;
-      float y;
-      float direction;
-      float speed;
-    } player_t;
-
-    explicit ClientEventGamePlayerSync(std::vector<player_t> players)
-        : ClientEventBase(PLAYERS_SYNC), players_(std::move(players)) {}
-    std::vector<player_t> players_;
-  };
   class ClientEventGameShotCreate : public ClientEventBase {
    public:
-    ClientEventGameShotCreate(uint32_t id, float x, float y, float direction,
-                              uint8_t shooter)
+    ClientEventGameShotCreate(Uint64 time, uint32_t id, float x, float y,
+                              float direction, uint8_t shooter)
         : ClientEventBase(SHOT_CREATE),
+          time_(time),
           id_(id),
           x_(x),
           y_(y),
           direction_(direction),
           shooter_(shooter) {}
+    Uint64 time_;
     uint32_t id_;
     float x_;
     float y_;
@@ -206,6 +288,15 @@ class Client {
   SDL_mutex* event_mutex_ = nullptr;
   std::queue<ClientEventBase> events_{};
 
+  /**
+   * \brief The latest world state, written by the network thread and read by
+   * the game loop.
+   */
+  TripleBuffer<world_state_t> world_{};
+  Uint32 worldSequence_ = 0;
+
+  LockstepSession lockstep_{};
+
   static void initializeThread();
 
   static Client* instance_;
@@ -216,8 +307,44 @@ class Client {
 
   void pushEvent(const ClientEventBase& event);
 
+  /**
+   * \brief Writes a message into the socket, terminated by
+   * `Protocol::MESSAGE_END`, accounting its size.
+   * \return The amount of bytes sent.
+   */
+  int send(const char* message, int length);
+
+  /**
+   * \brief Handles a single message split from the stream.
+   * \param message The message, null-terminated in place of its terminator.
+   * \param length The message's length.
+   */
+  void handleMessage(char* message, int length);
+
+  /**
+   * \brief Handles the lockstep relay's messages.
+   * \return Whether or not the message was consumed.
+   */
+  bool handleLockstep(const char* message, int length);
+
+  void sendPing();
+
+  /**
+   * \brief Handles the connection's own messages, such as pings and pongs.
+   * \return Whether or not the message was consumed.
+   */
+  bool handleControl(const char* message, int length);
+
   static Client::ClientEventBase* parseContent(char* buffer);
 
+  /**
+   * \brief Decodes a `ClientEventDataType::PLAYERS_SYNC` message.
+   * \param state The state to overwrite, its storage is reused.
+   * \return Whether or not the message was valid.
+   */
+  static bool parseWorldState(const char* message, size_t length,
+                              world_state_t& state);
+
  public:
   ~Client();
 
@@ -240,5 +367,67 @@ class Client {
    */
   int clientPollEvent(ClientEventBase* event);
 
+  /**
+   * \brief Takes the newest world state received from the server, skipping
+   * any older one that was not polled in time. Never blocks.
+   * \note Must only be called from the game loop's thread.
+   * \return The new world state, which stays valid until the next call, or
+   * nullptr if none arrived since the last call.
+   */
+  const world_state_t* pollWorldState();
+
+  /**
+   * \brief Get the lockstep match, which is started when a lockstep
+   * `ClientEventDataType::GAME_READY` arrives.
+   * \return The input buffer of every player.
+   */
+  LockstepSession& getLockstep();
+
+  /**
+   * \brief Schedules the local input in the lockstep match and sends it to
+   * the other players.
+   * \return Whether or not the input was scheduled.
+   */
+  bool sendInput(const LockstepSession::input_t& input);
+
+  /**
+   * \brief Sends the checksum of the local state after simulating a frame, so
+   * the server can detect a desync.
+   */
+  void sendChecksum(Uint32 frame, Uint32 checksum);
+
+  /**
+   * \brief Drives the lockstep match, must be called once per fixed step of
+   * the game loop. Sends the local input, simulates the next frame once every
+   * player's input arrived, and sends the checksum of the resulting state
+   * every LOCKSTEP_CHECKSUM_INTERVAL frames.
+   * \param input The local player's input for this step.
+   * \param simulate Simulates a frame with the input of every player, indexed
+   * by slot, and returns the checksum of the resulting state.
+   * \return Whether or not a frame was simulated, false while waiting for the
+   * other players or if no match is running.
+   */
+  bool stepLockstep(const LockstepSession::input_t& input,
+                    const LockstepSession::simulate_t& simulate);
+
+  /**
+   * \brief Get the measurements of the connection to the server.
+   * \return The round-trip time, jitter, and throughput of the connection.
+   */
+  const NetworkStats& getStats() const;
+
+  /**
+   * \brief Get the estimator that maps the local clock to the server's.
+   * \return The clock synchronization state.
+   */
+  const ClockSync& getClockSync() const;
+
+  /**
+   * \brief Get the estimated server time, which is the timeline snapshots and
+   * shots are tagged with, and the one inputs should be tagged with.
+   * \return The server time in microseconds.
+   */
+  Uint64 getServerTime() const;
+
   static Client* getInstance();
 };
@@ -0,0 +1,26 @@
+#include "Clock.h"
+
+namespace {
+Uint64 origin() {
+  static const Uint64 origin = SDL_GetPerformanceCounter();
+  return origin;
+}
+
+Uint64 frequency() {
+  static const Uint64 frequency = SDL_GetPerformanceFrequency();
+  return frequency;
+}
+}  // namespace
+
+Uint64 Clock::nanoseconds() {
+  const auto start = origin();
+  const auto ticks = SDL_GetPerformanceCounter() - start;
+  const auto hz = frequency();
+
+  // Split the conversion so the multiplication cannot overflow
+  return (ticks / hz) * 1000000000u + ((ticks % hz) * 1000000000u) / hz;
+}
+
+Uint64 Clock::microseconds() { return nanoseconds() / 1000u; }
+
+Uint64 Clock::milliseconds() { return nanoseconds() / 1000000u; }
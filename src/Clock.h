@@ -0,0 +1,30 @@
+#pragma once
+#include "SDL.h"
+
+/**
+ * \brief The Clock utility that reads SDL's high resolution performance
+ * counter and converts it to fixed units. Every value is relative to the first
+ * time the clock was read, so they are small and never wrap in practice.
+ */
+class Clock final {
+ public:
+  Clock() = delete;
+
+  /**
+   * \brief Get the current time in nanoseconds.
+   * \return The amount of nanoseconds elapsed since the clock's origin.
+   */
+  static Uint64 nanoseconds();
+
+  /**
+   * \brief Get the current time in microseconds.
+   * \return The amount of microseconds elapsed since the clock's origin.
+   */
+  static Uint64 microseconds();
+
+  /**
+   * \brief Get the current time in milliseconds.
+   * \return The amount of milliseconds elapsed since the clock's origin.
+   */
+  static Uint64 milliseconds();
+};
@@ -0,0 +1,122 @@
+#include "ClockSync.h"
+
+#include <cmath>
+
+namespace {
+/**
+ * \brief The largest drift accepted, in microseconds per microsecond. Crystal
+ * oscillators are well within 500 ppm, anything above that is noise.
+ */
+const double MAX_DRIFT = 0.0005;
+
+/**
+ * \brief The shortest span, in microseconds, the drift is fitted over.
+ */
+const double MIN_DRIFT_SPAN = 10000000.0;
+}  // namespace
+
+ClockSync::ClockSync() : mutex_(SDL_CreateMutex()) {}
+
+ClockSync::~ClockSync() { SDL_DestroyMutex(mutex_); }
+
+void ClockSync::addSample(const Uint64 sent, const Uint64 received,
+                          const Uint64 replied, const Uint64 now) {
+  const auto t0 = static_cast<double>(sent);
+  const auto t1 = static_cast<double>(received);
+  const auto t2 = static_cast<double>(replied);
+  const auto t3 = static_cast<double>(now);
+
+  const sample_t sample{t3, ((t1 - t0) + (t2 - t3)) / 2.0,
+                        std::fmax((t3 - t0) - (t2 - t1), 0.0)};
+
+  if (SDL_LockMutex(mutex_) != 0) return;
+
+  filter_[filterNext_] = sample;
+  filterNext_ = (filterNext_ + 1) % FILTER_SIZE;
+  if (filterCount_ < FILTER_SIZE) ++filterCount_;
+  ++samples_;
+
+  // The sample with the lowest delay was the least disturbed by queueing, so
+  // its offset is the most accurate one among the recent samples
+  auto best = filter_[0];
+  for (size_t i = 1; i < filterCount_; ++i) {
+    if (filter_[i].delay < best.delay) best = filter_[i];
+  }
+
+  // Only move forward in time, an older best sample was already used
+  if (best.local > reference_ || samples_ == 1) {
+    offset_ = best.offset;
+    reference_ = best.local;
+
+    history_[historyNext_] = best;
+    historyNext_ = (historyNext_ + 1) % DRIFT_SIZE;
+    if (historyCount_ < DRIFT_SIZE) ++historyCount_;
+    updateDrift();
+  }
+
+  SDL_UnlockMutex(mutex_);
+}
+
+void ClockSync::updateDrift() {
+  if (historyCount_ < 4) return;
+
+  // Least squares fit of the offset over the local time
+  double meanTime = 0;
+  double meanOffset = 0;
+  double first = history_[0].local;
+  double last = history_[0].local;
+  for (size_t i = 0; i < historyCount_; ++i) {
+    meanTime += history_[i].local;
+    meanOffset += history_[i].offset;
+    first = std::fmin(first, history_[i].local);
+    last = std::fmax(last, history_[i].local);
+  }
+
+  if (last - first < MIN_DRIFT_SPAN) return;
+
+  const auto count = static_cast<double>(historyCount_);
+  meanTime /= count;
+  meanOffset /= count;
+
+  double covariance = 0;
+  double variance = 0;
+  for (size_t i = 0; i < historyCount_; ++i) {
+    const auto time = history_[i].local - meanTime;
+    covariance += time * (history_[i].offset - meanOffset);
+    variance += time * time;
+  }
+
+  if (variance <= 0) return;
+  drift_ = std::fmax(-MAX_DRIFT, std::fmin(MAX_DRIFT, covariance / variance));
+}
+
+bool ClockSync::isSynchronized() const { return getSamples() >= 4; }
+
+Uint32 ClockSync::getSamples() const {
+  Uint32 samples = 0;
+  if (SDL_LockMutex(mutex_) == 0) {
+    samples = samples_;
+    SDL_UnlockMutex(mutex_);
+  }
+  return samples;
+}
+
+double ClockSync::getOffset(const Uint64 local) const {
+  double offset = 0;
+  if (SDL_LockMutex(mutex_) == 0) {
+    offset = offset_ + drift_ * (static_cast<double>(local) - reference_);
+    SDL_UnlockMutex(mutex_);
+  }
+  return offset;
+}
+
+double ClockSync::toRemote(const Uint64 local) const {
+  return static_cast<double>(local) + getOffset(local);
+}
+
+double ClockSync::toLocal(const Uint64 remote) const {
+  // The offset barely changes within a round trip, so one step is enough
+  const auto guess = static_cast<double>(remote) - getOffset(remote);
+  return static_cast<double>(remote) -
+         getOffset(static_cast<Uint64>(std::fmax(guess, 0.0)));
+}
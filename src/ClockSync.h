@@ -0,0 +1,119 @@
+#pragma once
+#include <array>
+
+#include "SDL.h"
+
+/**
+ * \brief The ClockSync class that estimates the offset and drift between the
+ * local clock and a remote one, NTP style, from the four timestamps of each
+ * ping/pong exchange.
+ *
+ * \note Samples are added from the network thread, while any other thread may
+ * read the estimate.
+ */
+class ClockSync final {
+  typedef struct {
+    /**
+     * \brief The local time the sample was taken at, in microseconds.
+     */
+    double local;
+    /**
+     * \brief The remote clock minus the local clock, in microseconds.
+     */
+    double offset;
+    /**
+     * \brief The round-trip delay excluding the remote's processing, in
+     * microseconds.
+     */
+    double delay;
+  } sample_t;
+
+  /**
+   * \brief The amount of recent samples the filter picks the best one from.
+   */
+  static const size_t FILTER_SIZE = 8;
+
+  /**
+   * \brief The amount of filtered offsets the drift is fitted on.
+   */
+  static const size_t DRIFT_SIZE = 32;
+
+  SDL_mutex* mutex_ = nullptr;
+
+  std::array<sample_t, FILTER_SIZE> filter_{};
+  size_t filterCount_ = 0;
+  size_t filterNext_ = 0;
+
+  std::array<sample_t, DRIFT_SIZE> history_{};
+  size_t historyCount_ = 0;
+  size_t historyNext_ = 0;
+
+  /**
+   * \brief The offset at the reference time, in microseconds.
+   */
+  double offset_ = 0;
+
+  /**
+   * \brief The local time the offset was estimated at, in microseconds.
+   */
+  double reference_ = 0;
+
+  /**
+   * \brief The rate the remote clock gains over the local one, in
+   * microseconds per microsecond.
+   */
+  double drift_ = 0;
+
+  Uint32 samples_ = 0;
+
+  void updateDrift();
+
+ public:
+  ClockSync();
+  ~ClockSync();
+  ClockSync(const ClockSync&) = delete;             // Copy Constructor
+  ClockSync(ClockSync&&) = delete;                  // Move Constructor
+  ClockSync& operator=(const ClockSync&) = delete;  // Assignment Operator
+  ClockSync& operator=(ClockSync&&) = delete;       // Move Operator
+
+  /**
+   * \brief Adds the timestamps of a completed ping/pong exchange.
+   * \param sent The local time the ping was sent at.
+   * \param received The remote time the ping was received at.
+   * \param replied The remote time the pong was sent at.
+   * \param now The local time the pong was received at.
+   */
+  void addSample(Uint64 sent, Uint64 received, Uint64 replied, Uint64 now);
+
+  /**
+   * \return Whether or not enough samples were taken for a stable estimate.
+   */
+  bool isSynchronized() const;
+
+  /**
+   * \return The amount of samples taken.
+   */
+  Uint32 getSamples() const;
+
+  /**
+   * \brief Get the estimated remote clock minus the local clock.
+   * \param local The local time to estimate the offset at, in microseconds.
+   * \return The offset in microseconds, including the drift since the last
+   * sample.
+   */
+  double getOffset(Uint64 local) const;
+
+  /**
+   * \brief Converts a local time into the remote clock's timeline.
+   * \param local The local time, in microseconds.
+   * \return The estimated remote time, in microseconds.
+   */
+  double toRemote(Uint64 local) const;
+
+  /**
+   * \brief Converts a remote time into the local clock's timeline.
+   * \param remote The remote time, in microseconds.
+   * \return The estimated local time, in microseconds.
+   */
+  double toLocal(Uint64 remote) const;
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include "SDL.h"
+
+class Texture;
+
+/**
+ * \brief The position of an entity, with the one it had before the last
+ * simulation step so it can be drawn in between.
+ */
+typedef struct {
+  float x;
+  float y;
+  float previousX;
+  float previousY;
+} position_t;
+
+/**
+ * \brief The velocity of an entity, in pixels per second.
+ */
+typedef struct {
+  float x;
+  float y;
+} velocity_t;
+
+/**
+ * \brief The frame of a texture an entity is drawn with, centered on its
+ * position, on the given RenderQueue layer.
+ */
+typedef struct {
+  Texture* texture;
+  Uint16 frame;
+  Uint16 width;
+  Uint16 height;
+  int layer;
+} sprite_t;
@@ -3,11 +3,59 @@
 
 #include <string>
 
+// Math constants
+const double PI = 3.14159265358979323846;
+
 // Window dimensions
 const int WIN_WIDTH = 1280;
 const int WIN_HEIGHT = 720;
 const int ANIMATION_TICKS_PER_SECOND = 1;
+
+// Simulation settings, the game is updated GAME_FRAMERATE times per second no
+// matter how often it is rendered, and catches up at most GAME_MAX_STEPS steps
+// per rendered frame
 const int GAME_FRAMERATE = 60;
+const int GAME_MAX_STEPS = 5;
+
+// Network settings, all times are in milliseconds
+const int SERVER_PORT = 9999;
+const int SERVER_TICKRATE = 30;
+const int NETWORK_POLL_INTERVAL = 10;
+const int NETWORK_PING_INTERVAL = 1000;
+const int NETWORK_SYNC_INTERVAL = 100;
+const int NETWORK_STATS_WINDOW = 1000;
+
+// Lockstep settings, all times are in frames
+const int LOCKSTEP_INPUT_DELAY = 3;
+const int LOCKSTEP_CHECKSUM_INTERVAL = 30;
+const int LOCKSTEP_MAX_PEERS = 8;
+
+// Job settings, the amount of concurrent game objects each job updates
+const int JOB_UPDATE_BATCH = 32;
+
+// The size in bytes of the pooled blocks jobs are allocated from, larger jobs
+// are allocated on their own
+const int JOB_BLOCK_SIZE = 256;
+
+// Picking settings, the side of the spatial index's cells in pixels
+const int SPATIAL_CELL_SIZE = 128;
+
+// Memory settings, the size in bytes of each block of a scene's frame arena
+const int FRAME_ARENA_BLOCK_SIZE = 64 * 1024;
+
+// The amount of objects an ObjectPool grows by when it runs out
+const int POOL_CHUNK_SIZE = 64;
+
+// Task settings, the milliseconds per simulation step the deferred tasks of a
+// scene may take before the rest roll over to the next step
+const int TASK_STEP_BUDGET = 2;
+
+// The tag of the pause menu, which Escape closes while the game is paused
+const char* const PAUSE_MENU_TAG = "pause-menu";
+
+// The amount of preloaded textures uploaded per frame, which spreads a
+// scene's uploads over several frames instead of hitching on one
+const int TEXTURE_UPLOADS_PER_FRAME = 4;
 
 enum class KeyboardKey {
   UNKNOWN = SDL_SCANCODE_UNKNOWN,
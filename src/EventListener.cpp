@@ -1,10 +1,28 @@
 #include "EventListener.h"
 
-EventListener::EventListener(GameObject* gameObject)
-    : gameObject_(gameObject) {}
+#include "EventRouter.h"
+#include "Scene.h"
+
+EventListener::EventListener(GameObject* gameObject,
+                             std::initializer_list<Uint32> types)
+    : gameObject_(gameObject), types_(types) {
+  const auto scene = gameObject_->getScene();
+  if (scene != nullptr) scene->getEventRouter().subscribe(this);
+}
+
+EventListener::~EventListener() {
+  const auto scene = gameObject_->getScene();
+  if (scene != nullptr) scene->getEventRouter().unsubscribe(this);
+}
 
 GameObject* EventListener::getGameObject() const { return gameObject_; }
 
 bool EventListener::getActive() { return active_; }
 
-void EventListener::setActive(bool active) { active_ = active; }
\ No newline at end of file
+void EventListener::setActive(bool active) { active_ = active; }
+
+bool EventListener::getRegion() const { return region_; }
+
+void EventListener::setRegion(const bool region) { region_ = region; }
+
+const std::vector<Uint32>& EventListener::getTypes() const { return types_; }
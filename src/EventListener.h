@@ -1,9 +1,14 @@
 #pragma once
+#include <initializer_list>
+#include <vector>
+
 #include "GameObject.h"
 
 /**
  * \brief The abstract EventListener class, it must be inherited and override
- * EventListener::run(SDL_Event event) before using it.
+ * EventListener::run(const SDL_Event& event) before using it. Listeners are
+ * subscribed to their game object's scene when constructed, and only receive
+ * the event types they declared.
  */
 class EventListener {
   /**
@@ -16,23 +21,36 @@ class EventListener {
    */
   bool active_ = true;
 
+  /**
+   * \brief Whether or not mouse events outside of the game object are
+   * skipped.
+   */
+  bool region_ = false;
+
+  /**
+   * \brief The event types to receive, or every type if empty.
+   */
+  std::vector<Uint32> types_;
+
  public:
   /**
    * \brief Construct a new EventListener.
    * \param gameObject The GameObject instance that owns this listener.
+   * \param types The event types to receive, every type if none are given.
    */
-  explicit EventListener(GameObject* gameObject);
+  explicit EventListener(GameObject* gameObject,
+                         std::initializer_list<Uint32> types = {});
 
   /**
-   * \brief Destruct this EventListener.
+   * \brief Destruct this EventListener, unsubscribing it.
    */
-  virtual ~EventListener() = default;
+  virtual ~EventListener();
 
   /**
    * \brief Processes the events as they are received from the event loop.
    * \param event The SDL event received for further processing.
    */
-  virtual void run(SDL_Event event) = 0;
+  virtual void run(const SDL_Event& event) = 0;
 
   /**
    * \brief Returns the GameObject instance that owns this listener.
@@ -49,4 +67,21 @@ class EventListener {
    * \brief Sets the listener to process or stop processing events.
    */
   void setActive(bool active);
+
+  /**
+   * \return Whether or not mouse events outside of the game object are
+   * skipped.
+   */
+  bool getRegion() const;
+
+  /**
+   * \brief Sets the listener to only receive the mouse events inside of its
+   * game object's rectangle.
+   */
+  void setRegion(bool region);
+
+  /**
+   * \return The event types the listener receives, every type if empty.
+   */
+  const std::vector<Uint32>& getTypes() const;
 };
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "EventRouter.h"
+
+#include <algorithm>
+
+#include "Camera.h"
+#include "EventListener.h"
+#include "GameObject.h"
+#include "Input.h"
+
+EventRouter::EventRouter(const Camera& camera) : camera_(camera) {}
+
+void EventRouter::subscribe(EventListener* listener) {
+  const auto& types = listener->getTypes();
+  if (types.empty()) {
+    all_.push_back(listener);
+    return;
+  }
+
+  for (const auto type : types) byType_[type].push_back(listener);
+}
+
+void EventRouter::unsubscribe(EventListener* listener) {
+  const auto& types = listener->getTypes();
+  if (types.empty()) {
+    remove(all_, listener);
+    return;
+  }
+
+  for (const auto type : types) {
+    const auto it = byType_.find(type);
+    if (it != byType_.end()) remove(it->second, listener);
+  }
+}
+
+void EventRouter::remove(std::vector<EventListener*>& listeners,
+                         EventListener* listener) {
+  const auto it = std::find(listeners.begin(), listeners.end(), listener);
+  if (it == listeners.end()) return;
+
+  // Erasing would shift the listeners a running dispatch is iterating
+  if (dispatching_ > 0) {
+    *it = nullptr;
+    dirty_ = true;
+  } else {
+    listeners.erase(it);
+  }
+}
+
+void EventRouter::dispatch(const SDL_Event& event) {
+  // Mouse events are matched against regions in world coordinates
+  SDL_Point point{};
+  auto positional = true;
+  switch (event.type) {
+    case SDL_MOUSEMOTION:
+      point = {event.motion.x, event.motion.y};
+      break;
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+      point = {event.button.x, event.button.y};
+      break;
+    case SDL_MOUSEWHEEL: {
+      const auto position = Input::getMousePosition();
+      point = {position.getX(), position.getY()};
+      break;
+    }
+    default:
+      positional = false;
+      break;
+  }
+  if (positional) point = camera_.toWorld(point);
+  const auto* position = positional ? &point : nullptr;
+
+  ++dispatching_;
+  const auto it = byType_.find(event.type);
+  if (it != byType_.end()) run(it->second, event, position);
+  run(all_, event, position);
+  --dispatching_;
+
+  if (dispatching_ > 0 || !dirty_) return;
+  const auto isNull = [](const EventListener* listener) {
+    return listener == nullptr;
+  };
+  for (auto& pair : byType_) {
+    auto& listeners = pair.second;
+    listeners.erase(std::remove_if(listeners.begin(), listeners.end(), isNull),
+                    listeners.end());
+  }
+  all_.erase(std::remove_if(all_.begin(), all_.end(), isNull), all_.end());
+  dirty_ = false;
+}
+
+void EventRouter::run(const std::vector<EventListener*>& listeners,
+                      const SDL_Event& event, const SDL_Point* point) {
+  // Listeners subscribed by this dispatch are left for the next one
+  const auto size = listeners.size();
+  for (size_t i = 0; i < size; ++i) {
+    const auto listener = listeners[i];
+    if (listener == nullptr || !listener->getActive()) continue;
+
+    const auto gameObject = listener->getGameObject();
+    if (!gameObject->isReceivingEvents()) continue;
+    if (point != nullptr && listener->getRegion()) {
+      const auto rect = gameObject->getRect();
+      if (!SDL_PointInRect(point, &rect)) continue;
+    }
+
+    // Running may delete the game object, so it is woken up beforehand
+    gameObject->requestUpdate();
+    listener->run(event);
+  }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <unordered_map>
+#include <vector>
+
+#include "SDL.h"
+
+class Camera;
+class EventListener;
+
+/**
+ * \brief The EventRouter class that hands every event only to the listeners
+ * subscribed to its type, instead of broadcasting it through every game
+ * object. Listeners limited to a region also skip the mouse events outside of
+ * their game object.
+ *
+ * \note Listeners may subscribe and unsubscribe while an event is being
+ * dispatched, the ones subscribed meanwhile receive the next event.
+ */
+class EventRouter final {
+  const Camera& camera_;
+  std::unordered_map<Uint32, std::vector<EventListener*>> byType_{};
+
+  /**
+   * \brief The listeners subscribed to every event type.
+   */
+  std::vector<EventListener*> all_{};
+
+  /**
+   * \brief How many dispatches are running, during which unsubscribed
+   * listeners are only cleared and removed afterwards.
+   */
+  int dispatching_ = 0;
+  bool dirty_ = false;
+
+  void remove(std::vector<EventListener*>& listeners, EventListener* listener);
+  void run(const std::vector<EventListener*>& listeners,
+           const SDL_Event& event, const SDL_Point* point);
+
+ public:
+  /**
+   * \param camera The view mouse positions are converted to the world with.
+   */
+  explicit EventRouter(const Camera& camera);
+
+  /**
+   * \brief Subscribes a listener to the event types it declared, or to every
+   * event if it declared none.
+   */
+  void subscribe(EventListener* listener);
+
+  /**
+   * \brief Stops routing events to a listener.
+   */
+  void unsubscribe(EventListener* listener);
+
+  /**
+   * \brief Runs the listeners subscribed to the event's type, in the order
+   * they subscribed, and then the ones subscribed to every event.
+   */
+  void dispatch(const SDL_Event& event);
+};
@@ -0,0 +1,44 @@
+#include "FrameArena.h"
+
+FrameArena::FrameArena(const size_t blockSize) : blockSize_(blockSize) {}
+
+FrameArena::~FrameArena() {
+  for (const auto& block : blocks_) delete[] block.data;
+  blocks_.clear();
+}
+
+void* FrameArena::allocate(const size_t size, const size_t alignment) {
+  // Blocks that are too small for the allocation are skipped until the reset
+  while (block_ < blocks_.size()) {
+    const auto& block = blocks_[block_];
+    const auto address = reinterpret_cast<size_t>(block.data) + offset_;
+    const auto padding = (alignment - address % alignment) % alignment;
+    if (offset_ + padding + size <= block.size) {
+      offset_ += padding + size;
+      return block.data + offset_ - size;
+    }
+
+    ++block_;
+    offset_ = 0;
+  }
+
+  // Only frames busier than every previous one reach the heap
+  const auto needed = size + alignment;
+  const auto blockSize = needed > blockSize_ ? needed : blockSize_;
+  blocks_.push_back({new Uint8[blockSize], blockSize});
+  return allocate(size, alignment);
+}
+
+void FrameArena::reset() {
+  block_ = 0;
+  offset_ = 0;
+  ++generation_;
+}
+
+Uint32 FrameArena::getGeneration() const { return generation_; }
+
+size_t FrameArena::getCapacity() const {
+  size_t capacity = 0;
+  for (const auto& block : blocks_) capacity += block.size;
+  return capacity;
+}
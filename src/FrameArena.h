@@ -0,0 +1,177 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Constants.h"
+#include "SDL.h"
+
+/**
+ * \brief The FrameArena class that hands out memory for data that only lives
+ * for a frame by bumping an offset, and frees all of it at once on reset. The
+ * blocks are kept across resets, so once the busiest frame was seen the
+ * arena stops asking the heap for memory.
+ *
+ * \note Destructors are not run on reset, ArenaCallback::destroy() is the way
+ * to release what callables own, and ArenaCallback::detach() the way to keep
+ * them past the reset. The arena is not thread safe.
+ */
+class FrameArena final {
+  typedef struct {
+    Uint8* data;
+    size_t size;
+  } block_t;
+
+  std::vector<block_t> blocks_{};
+  size_t blockSize_;
+  size_t block_ = 0;
+  size_t offset_ = 0;
+
+  /**
+   * \brief Increased on every reset, so containers notice their memory was
+   * released.
+   */
+  Uint32 generation_ = 0;
+
+ public:
+  explicit FrameArena(size_t blockSize = FRAME_ARENA_BLOCK_SIZE);
+  ~FrameArena();
+  FrameArena(const FrameArena&) = delete;             // Copy Constructor
+  FrameArena(FrameArena&&) = delete;                  // Move Constructor
+  FrameArena& operator=(const FrameArena&) = delete;  // Assignment Operator
+  FrameArena& operator=(FrameArena&&) = delete;       // Move Operator
+
+  /**
+   * \brief Allocates memory valid until the next FrameArena::reset().
+   * \param size The amount of bytes.
+   * \param alignment The alignment, which must be a power of two.
+   * \return The memory, which is never nullptr.
+   */
+  void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+  /**
+   * \brief Constructs a value in the arena.
+   * \return The value, whose destructor is never run by the arena.
+   */
+  template <class T, class... A>
+  T* create(A&&... arguments) {
+    return new (allocate(sizeof(T), alignof(T)))
+        T(std::forward<A>(arguments)...);
+  }
+
+  /**
+   * \brief Releases every allocation at once, keeping the blocks for reuse.
+   */
+  void reset();
+
+  Uint32 getGeneration() const;
+
+  /**
+   * \return The amount of bytes in the blocks, used or not.
+   */
+  size_t getCapacity() const;
+};
+
+/**
+ * \brief The ArenaCallback class that stores a callable in a FrameArena
+ * instead of on the heap. It is trivially copyable, so it fits in an
+ * ArenaVector, and every copy calls the same callable.
+ */
+class ArenaCallback final {
+  void* callable_ = nullptr;
+  void (*invoke_)(void*) = nullptr;
+  void (*destroy_)(void*) = nullptr;
+  std::function<void()> (*detach_)(void*) = nullptr;
+
+ public:
+  ArenaCallback() = default;
+
+  /**
+   * \param arena The arena the callable is moved into.
+   * \param callable A function taking no arguments.
+   */
+  template <class F>
+  ArenaCallback(FrameArena& arena, F callable)
+      : callable_(arena.create<F>(std::move(callable))),
+        invoke_([](void* stored) { (*static_cast<F*>(stored))(); }),
+        destroy_([](void* stored) { static_cast<F*>(stored)->~F(); }),
+        detach_([](void* stored) {
+          auto* callable = static_cast<F*>(stored);
+          std::function<void()> detached(std::move(*callable));
+          callable->~F();
+          return detached;
+        }) {}
+
+  void operator()() const { invoke_(callable_); }
+
+  /**
+   * \brief Runs the callable's destructor, which must happen once before the
+   * arena resets if it owns anything.
+   */
+  void destroy() const { destroy_(callable_); }
+
+  /**
+   * \brief Moves the callable out of the arena, for callbacks that must
+   * outlive the frame. Like ArenaCallback::destroy(), it must happen once.
+   * \return The callable, stored on the heap.
+   */
+  std::function<void()> detach() const { return detach_(callable_); }
+};
+
+/**
+ * \brief The ArenaVector class that grows its storage inside a FrameArena.
+ * Outgrown storage stays in the arena until it resets, and the contents are
+ * dropped by then, so it must be emptied before the arena resets.
+ * \tparam T The value type, which must be trivially copyable.
+ */
+template <class T>
+class ArenaVector final {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "Arena values must be trivially copyable");
+
+  FrameArena& arena_;
+  T* data_ = nullptr;
+  size_t size_ = 0;
+  size_t capacity_ = 0;
+  Uint32 generation_ = 0;
+
+ public:
+  explicit ArenaVector(FrameArena& arena)
+      : arena_(arena), generation_(arena.getGeneration()) {}
+
+  void push_back(const T& value) {
+    // The storage of a previous frame was released along with the arena
+    if (generation_ != arena_.getGeneration()) {
+      data_ = nullptr;
+      size_ = 0;
+      capacity_ = 0;
+      generation_ = arena_.getGeneration();
+    }
+
+    if (size_ == capacity_) {
+      const auto capacity = capacity_ == 0 ? 16 : capacity_ * 2;
+      auto* data =
+          static_cast<T*>(arena_.allocate(capacity * sizeof(T), alignof(T)));
+      for (size_t i = 0; i < size_; ++i) data[i] = data_[i];
+      data_ = data;
+      capacity_ = capacity;
+    }
+
+    data_[size_++] = value;
+  }
+
+  T& operator[](const size_t index) { return data_[index]; }
+  const T& operator[](const size_t index) const { return data_[index]; }
+  T* begin() { return data_; }
+  T* end() { return data_ + size_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  /**
+   * \brief Empties the vector, keeping its storage for this frame.
+   */
+  void clear() { size_ = 0; }
+};
@@ -0,0 +1,97 @@
+#include "FramePacer.h"
+
+#include "Clock.h"
+
+namespace {
+/**
+ * \brief The bounds of the calibrated slack, in nanoseconds. Below the lower
+ * one the scheduler's noise is not captured, and above the upper one spinning
+ * would waste more time than the sleep saves.
+ */
+const Uint64 MIN_SLEEP_SLACK = 500000;
+const Uint64 MAX_SLEEP_SLACK = 4000000;
+
+/**
+ * \brief The amount of SDL_Delay(1) calls the calibration measures.
+ */
+const int CALIBRATION_SAMPLES = 8;
+}  // namespace
+
+Uint64 FramePacer::sleepSlack_ = 0;
+
+FramePacer::FramePacer(const Uint64 interval, const Uint64 now)
+    : interval_(interval == 0 ? 1 : interval), deadline_(now + interval_) {}
+
+FramePacer FramePacer::fromRate(const Uint32 rate) {
+  return {Uint64{1000000000} / (rate == 0 ? 1 : rate), Clock::nanoseconds()};
+}
+
+void FramePacer::reset(const Uint64 now) { deadline_ = now + interval_; }
+
+void FramePacer::advance(const Uint64 now) {
+  deadline_ += interval_;
+
+  // Skip the intervals that were missed entirely instead of running them in a
+  // burst, while staying aligned to the original schedule
+  if (now >= deadline_) {
+    const auto skipped = (now - deadline_) / interval_ + 1;
+    missed_ += static_cast<Uint32>(skipped);
+    deadline_ += skipped * interval_;
+  }
+}
+
+bool FramePacer::isDue(const Uint64 now) {
+  if (now < deadline_) return false;
+
+  advance(now);
+  return true;
+}
+
+void FramePacer::wait() {
+  sleepUntil(deadline_);
+  advance(Clock::nanoseconds());
+}
+
+Uint64 FramePacer::getRemaining(const Uint64 now) const {
+  return now >= deadline_ ? 0 : deadline_ - now;
+}
+
+Uint64 FramePacer::getInterval() const { return interval_; }
+
+Uint32 FramePacer::getMissed() const { return missed_; }
+
+void FramePacer::calibrate() {
+  // Keep the worst oversleep, as a single late wake-up is a visible hitch
+  Uint64 worst = 0;
+  for (int i = 0; i < CALIBRATION_SAMPLES; ++i) {
+    const auto start = Clock::nanoseconds();
+    SDL_Delay(1);
+    const auto elapsed = Clock::nanoseconds() - start;
+    if (elapsed > 1000000 && elapsed - 1000000 > worst) {
+      worst = elapsed - 1000000;
+    }
+  }
+
+  // Leave some headroom over the measurement
+  const auto slack = worst + worst / 4;
+  sleepSlack_ = slack < MIN_SLEEP_SLACK
+                    ? MIN_SLEEP_SLACK
+                    : (slack > MAX_SLEEP_SLACK ? MAX_SLEEP_SLACK : slack);
+}
+
+void FramePacer::sleepUntil(const Uint64 deadline) {
+  if (sleepSlack_ == 0) calibrate();
+
+  auto now = Clock::nanoseconds();
+  while (now < deadline) {
+    const auto remaining = deadline - now;
+
+    // Sleep in whole milliseconds while the oversleep cannot miss the
+    // deadline, then spin for the rest
+    if (remaining > sleepSlack_ + 1000000) {
+      SDL_Delay(static_cast<Uint32>((remaining - sleepSlack_) / 1000000));
+    }
+
+    now = Clock::nanoseconds();
+  }
+}
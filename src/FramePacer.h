@@ -0,0 +1,102 @@
+#pragma once
+#include "SDL.h"
+
+/**
+ * \brief The FramePacer utility that schedules interval-running loops on the
+ * high resolution clock. Deadlines are advanced by exact multiples of the
+ * interval, so rounding and late wake-ups never accumulate into drift, and the
+ * intervals that were skipped entirely are counted as missed.
+ */
+class FramePacer final {
+  /**
+   * \brief The amount of nanoseconds between two deadlines.
+   */
+  Uint64 interval_ = 0;
+  /**
+   * \brief The time in nanoseconds the next interval is due at.
+   */
+  Uint64 deadline_ = 0;
+  /**
+   * \brief The amount of intervals skipped because they were run too late.
+   */
+  Uint32 missed_ = 0;
+
+  /**
+   * \brief The amount of nanoseconds SDL_Delay() may oversleep, the last part
+   * of every wait is spent spinning instead.
+   */
+  static Uint64 sleepSlack_;
+
+  /**
+   * \brief Moves the deadline past the given time.
+   */
+  void advance(Uint64 now);
+
+ public:
+  /**
+   * \brief Create a new instance of FramePacer.
+   * \param interval The amount of nanoseconds between two deadlines.
+   * \param now The current time in nanoseconds, the first deadline is one
+   * interval after it.
+   */
+  FramePacer(Uint64 interval, Uint64 now);
+
+  /**
+   * \brief Create a new instance of FramePacer that runs a given amount of
+   * times per second, starting now.
+   * \param rate The amount of intervals per second.
+   */
+  static FramePacer fromRate(Uint32 rate);
+
+  /**
+   * \brief Restarts the schedule, the next deadline is one interval after the
+   * given time.
+   * \param now The current time in nanoseconds.
+   */
+  void reset(Uint64 now);
+
+  /**
+   * \brief Checks whether or not the deadline passed without blocking, moving
+   * it to the next interval if it did.
+   * \param now The current time in nanoseconds.
+   * \return Whether or not the interval is ready to run.
+   */
+  bool isDue(Uint64 now);
+
+  /**
+   * \brief Blocks until the deadline, sleeping first and spinning for the
+   * last stretch, then moves it to the next interval.
+   */
+  void wait();
+
+  /**
+   * \brief Get the remaining time until the deadline.
+   * \param now The current time in nanoseconds.
+   * \return The remaining time in nanoseconds, 0 if it already passed.
+   */
+  Uint64 getRemaining(Uint64 now) const;
+
+  /**
+   * \return The amount of nanoseconds between two deadlines.
+   */
+  Uint64 getInterval() const;
+
+  /**
+   * \return The amount of intervals skipped because they were run too late.
+   */
+  Uint32 getMissed() const;
+
+  /**
+   * \brief Measures how much SDL_Delay() oversleeps on this system, so waits
+   * wake up early enough to spin for the rest. Runs on the first wait if it
+   * was not called before.
+   */
+  static void calibrate();
+
+  /**
+   * \brief Blocks until the given time, sleeping first and spinning for the
+   * last stretch.
+   * \param deadline The time to wake up at, in nanoseconds.
+   */
+  static void sleepUntil(Uint64 deadline);
+};
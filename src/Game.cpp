@@ -1,8 +1,14 @@
 #include "Game.h"
 
+#include <cstdio>
+
+#include "AllocationCounter.h"
+#include "Clock.h"
 #include "Constants.h"
 #include "FontManager.h"
+#include "FramePacer.h"
 #include "MenuScene.h"
+#include "RenderQueue.h"
 #include "SDLAudioManager.h"
 #include "SDLError.h"
 #include "SDL_mixer.h"
@@ -11,7 +17,20 @@
 #include "Texture.h"
 #include "TextureManager.h"
 
+bool Game::headless_ = false;
+RenderMode Game::renderMode_ = RenderMode::ACCELERATED;
+Uint32 Game::frameLimit_ = 0;
+
 Game::Game() {
+  // Without a display or sound card, SDL's dummy drivers stand in for them
+  if (headless_) {
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+    SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+    if (renderMode_ == RenderMode::ACCELERATED) {
+      renderMode_ = RenderMode::SOFTWARE;
+    }
+  }
+
   if (SDL_Init(SDL_INIT_EVENTS | SDL_INIT_TIMER | SDL_INIT_AUDIO) != 0) {
     const auto message =
         std::string("Error initializing SDL.\nReason: ") + SDL_GetError();
@@ -30,16 +49,25 @@ Game::Game() {
     throw SDLError(message);
   }
 
+  // Measure the sleep accuracy before the first frame has to be paced
+  FramePacer::calibrate();
+
   // Create the window and renderer
-  window_ = SDL_CreateWindow("SnowShooter", SDL_WINDOWPOS_CENTERED,
-                             SDL_WINDOWPOS_CENTERED, WIN_WIDTH, WIN_HEIGHT,
-                             SDL_WINDOW_SHOWN);
-  renderer_ = SDL_CreateRenderer(
-      window_, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+  window_ = SDL_CreateWindow(
+      "SnowShooter", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+      WIN_WIDTH, WIN_HEIGHT, headless_ ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN);
+  const Uint32 flags =
+      renderMode_ == RenderMode::ACCELERATED
+          ? SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC
+          : SDL_RENDERER_SOFTWARE;
+  renderer_ = SDL_CreateRenderer(window_, -1, flags);
 
   // If window or renderer is a null pointer, throw a SDLError
   if (window_ == nullptr || renderer_ == nullptr)
     throw SDLError("Error loading the SDL window or renderer");
+
+  backend_ = new RenderBackend(renderer_, renderMode_);
+  renderQueue_ = new RenderQueue(backend_);
 }
 
 void Game::load() {
@@ -62,6 +90,8 @@ void Game::load() {
 }
 
 Game::~Game() {
+  delete renderQueue_;
+  delete backend_;
   SDL_DestroyRenderer(renderer_);
   SDL_DestroyWindow(window_);
 
@@ -72,14 +102,43 @@ Game::~Game() {
   Mix_Quit();
 }
 
-void Game::run() const {
+bool Game::run() const {
+  const auto start = Clock::nanoseconds();
   while (!sceneMachine_->isEmpty()) {
     sceneMachine_->getCurrentScene()->run();
   }
+  if (frameLimit_ == 0) return true;
+
+  const auto& stats = backend_->getStats();
+  const auto seconds = static_cast<double>(Clock::nanoseconds() - start) / 1e9;
+  const auto frames = static_cast<double>(stats.frames > 0 ? stats.frames : 1);
+  printf("Frames: %llu in %.3f s (%.3f ms per frame, %.1f FPS)\n",
+         static_cast<unsigned long long>(stats.frames), seconds,
+         seconds * 1000 / frames, frames / seconds);
+  printf("Draw calls: %llu (%.1f per frame)\n",
+         static_cast<unsigned long long>(stats.drawCalls),
+         static_cast<double>(stats.drawCalls) / frames);
+  printf("Texture uploads: %llu\n",
+         static_cast<unsigned long long>(stats.textureUploads));
+  if (!AllocationCounter::isEnabled()) return true;
+
+  printf("Allocating frames: %u\n", allocatingFrames_);
+  return allocatingFrames_ == 0;
+}
+
+bool Game::addFrame() {
+  ++frames_;
+  return frameLimit_ != 0 && frames_ >= frameLimit_;
 }
 
+void Game::addAllocatingFrame() { ++allocatingFrames_; }
+
 SDL_Renderer* Game::getRenderer() { return getInstance()->renderer_; }
 
+RenderBackend* Game::getRenderBackend() { return getInstance()->backend_; }
+
+RenderQueue* Game::getRenderQueue() { return getInstance()->renderQueue_; }
+
 Game* Game::instance_ = nullptr;
 
 Game* Game::getInstance() {
@@ -92,4 +151,14 @@ Game* Game::getInstance() {
 
 SceneMachine* Game::getSceneMachine() { return getInstance()->sceneMachine_; }
 
-SDL_Window* Game::getWindow() { return getInstance()->window_; }
\ No newline at end of file
+SDL_Window* Game::getWindow() { return getInstance()->window_; }
+
+void Game::setHeadless(const bool headless) { headless_ = headless; }
+
+bool Game::isHeadless() { return headless_; }
+
+void Game::setRenderMode(const RenderMode mode) { renderMode_ = mode; }
+
+void Game::setFrameLimit(const Uint32 frames) { frameLimit_ = frames; }
+
+bool Game::isBenchmark() { return frameLimit_ != 0; }
\ No newline at end of file
@@ -1,29 +1,89 @@
 #pragma once
 
+#include "RenderBackend.h"
 #include "SDL.h"
 
+class RenderQueue;
 class Scene;
 class SceneMachine;
 
 class Game final {
   static Game* instance_;
+  static bool headless_;
+  static RenderMode renderMode_;
+  static Uint32 frameLimit_;
   SDL_Window* window_ = nullptr;
   SDL_Renderer* renderer_ = nullptr;
+  RenderBackend* backend_ = nullptr;
+  RenderQueue* renderQueue_ = nullptr;
   SceneMachine* sceneMachine_ = nullptr;
   Game();
 
   bool loaded_ = false;
+  Uint32 frames_ = 0;
+  Uint32 allocatingFrames_ = 0;
 
  public:
   ~Game();
-  void run() const;
+  /**
+   * \brief Runs scenes until the stack is empty, then prints the statistics
+   * of a benchmark.
+   * \return Whether or not the run passed its checks, false if a benchmark
+   * frame allocated after its scene warmed up.
+   */
+  bool run() const;
   void load();
+
+  /**
+   * \brief Counts a rendered frame towards the frame limit.
+   * \return Whether or not the limit was reached, so the game should end.
+   */
+  bool addFrame();
+
+  /**
+   * \brief Counts a frame that allocated after its scene warmed up, which
+   * fails benchmarks when allocations are counted.
+   */
+  void addAllocatingFrame();
   // Get the SDL_Renderer instance.
   static SDL_Renderer* getRenderer();
+  // Get the backend every draw and texture upload goes through.
+  static RenderBackend* getRenderBackend();
+  // Get the queue every texture is drawn through.
+  static RenderQueue* getRenderQueue();
   // Get the Game instance.
   static Game* getInstance();
   // Get the SceneMachine instance.
   static SceneMachine* getSceneMachine();
   // Get the SDL_Window instance
   static SDL_Window* getWindow();
+
+  /**
+   * \brief Runs the game without showing a window or playing audio, which
+   * draws in software unless the render mode is RenderMode::NONE. Must be
+   * called before the instance is created.
+   */
+  static void setHeadless(bool headless);
+
+  static bool isHeadless();
+
+  /**
+   * \brief Sets how frames are drawn, must be called before the instance is
+   * created. Defaults to RenderMode::ACCELERATED.
+   */
+  static void setRenderMode(RenderMode mode);
+
+  /**
+   * \brief Ends the game after an amount of frames, and runs one simulation
+   * step per frame as fast as possible instead of in real time, so runs can
+   * be compared. Must be called before the instance is created.
+   * \param frames The amount of frames, or 0 to run until quitting.
+   */
+  static void setFrameLimit(Uint32 frames);
+
+  /**
+   * \return Whether or not a frame limit is set, in which case frames are
+   * not paced.
+   */
+  static bool isBenchmark();
 };
\ No newline at end of file
@@ -1,5 +1,9 @@
 #include "GameObject.h"
 
+#include <algorithm>
+#include <cmath>
+
+#include "Constants.h"
 #include "EventListener.h"
 #include "Game.h"
 #include "Scene.h"
@@ -12,6 +16,9 @@ GameObject::GameObject(Scene* scene, Texture* texture,
     : scene_(scene), position_(position), size_(size), texture_(texture) {}
 
 GameObject::~GameObject() {
+  // Stop the animations of its properties
+  if (scene_ != nullptr) scene_->getTweens().cancel(this);
+
   // Clean up event listeners
   for (auto listener : eventListeners_) delete listener;
   eventListeners_.clear();
@@ -29,40 +36,135 @@ void GameObject::awake() {
 
 void GameObject::render(SDL_Rect rect) const {
   if (getRenderable() && texture_ != nullptr) {
-    texture_->renderFrame(rect, texture_->getAnimation()[texture_->getFrame()]);
+    texture_->renderFrame(rect, texture_->getAnimation()[texture_->getFrame()],
+                          getWorldTransform().rotation, layer_);
+  }
+  // Whole subtrees out of view are skipped
+  const auto camera = scene_ != nullptr ? &scene_->getCamera() : nullptr;
+  for (auto child : children_) {
+    if (!child->getRenderable()) continue;
+    if (camera != nullptr && !camera->isVisible(child->getBounds())) continue;
+    child->render();
   }
-  for (auto child : children_)
-    if (child->getRenderable()) child->render();
 }
 
-void GameObject::render() const { render(getRect()); }
+void GameObject::render() const {
+  render(scene_ != nullptr ? scene_->getCamera().toScreen(getRect())
+                           : getRect());
+}
 
 void GameObject::update() {
   for (auto child : children_)
     if (child->getActive()) child->update();
 }
 
-void GameObject::handleEvents(const SDL_Event event) {
-  for (auto listener : eventListeners_)
-    if (listener->getActive()) listener->run(event);
-  for (auto child : children_)
-    if (child->getActive()) child->handleEvents(event);
-}
-
 GameObject* GameObject::addEventListener(EventListener* eventListener) {
   eventListeners_.push_back(eventListener);
   return this;
 }
 
 SDL_Rect GameObject::getRect() const {
-  return {position_.getX() - size_.getX() / 2,
-          position_.getY() - size_.getY() / 2, size_.getX(), size_.getY()};
+  const auto& world = getWorldTransform();
+  const auto width = static_cast<int>(size_.getX() * world.scaleX);
+  const auto height = static_cast<int>(size_.getY() * world.scaleY);
+  return {static_cast<int>(world.x) - width / 2,
+          static_cast<int>(world.y) - height / 2, width, height};
+}
+
+SDL_Rect GameObject::getBounds() const {
+  if (!boundsDirty_) return bounds_;
+
+  bounds_ = getRect();
+  const auto rotation = getWorldTransform().rotation;
+  if (rotation != 0) {
+    // Grow the rectangle to fit its rotated corners
+    const auto radians = rotation * PI / 180;
+    const auto cosine = std::fabs(std::cos(radians));
+    const auto sine = std::fabs(std::sin(radians));
+    const auto width = bounds_.w * cosine + bounds_.h * sine;
+    const auto height = bounds_.w * sine + bounds_.h * cosine;
+    const auto centerX = bounds_.x + bounds_.w / 2;
+    const auto centerY = bounds_.y + bounds_.h / 2;
+    bounds_ = {centerX - static_cast<int>(width / 2),
+               centerY - static_cast<int>(height / 2),
+               static_cast<int>(std::ceil(width)),
+               static_cast<int>(std::ceil(height))};
+  }
+
+  for (auto child : children_) {
+    const auto childBounds = child->getBounds();
+    SDL_UnionRect(&bounds_, &childBounds, &bounds_);
+  }
+  boundsDirty_ = false;
+  return bounds_;
+}
+
+const GameObject::transform_t& GameObject::getWorldTransform() const {
+  if (!transformDirty_) return world_;
+
+  const auto x = static_cast<double>(position_.getX());
+  const auto y = static_cast<double>(position_.getY());
+  if (parent_ == nullptr) {
+    world_ = {x, y, scale_.getX(), scale_.getY(), rotation_};
+  } else {
+    // The local position is scaled and rotated by the parent's transform
+    const auto& parent = parent_->getWorldTransform();
+    const auto radians = parent.rotation * PI / 180;
+    const auto cosine = std::cos(radians);
+    const auto sine = std::sin(radians);
+    const auto localX = x * parent.scaleX;
+    const auto localY = y * parent.scaleY;
+    world_ = {parent.x + localX * cosine - localY * sine,
+              parent.y + localX * sine + localY * cosine,
+              parent.scaleX * scale_.getX(), parent.scaleY * scale_.getY(),
+              parent.rotation + rotation_};
+  }
+
+  transformDirty_ = false;
+  return world_;
+}
+
+Vector2D<int> GameObject::getWorldPosition() const {
+  const auto& world = getWorldTransform();
+  return {static_cast<int>(world.x), static_cast<int>(world.y)};
+}
+
+void GameObject::invalidateTransform() {
+  if (transformDirty_) return;
+
+  transformDirty_ = true;
+  boundsDirty_ = true;
+  for (auto child : children_) child->invalidateTransform();
+}
+
+void GameObject::invalidate() {
+  auto root = this;
+  root->boundsDirty_ = true;
+  while (root->parent_ != nullptr) {
+    root = root->parent_;
+    root->boundsDirty_ = true;
+  }
+
+  // Only the instances added to a scene are indexed, once per change
+  if (root->moved_ || root->scene_ == nullptr) return;
+  if (root->handle_.generation == 0) return;
+
+  root->moved_ = true;
+  root->scene_->moveGameObject(root->handle_);
 }
 
 Scene* GameObject::getScene() const { return scene_; }
 
+GameObject::handle_t GameObject::getHandle() const { return handle_; }
+void GameObject::setHandle(const GameObject::handle_t& handle) {
+  handle_ = handle;
+}
+
 bool GameObject::hasParent() const { return parent_ != nullptr; }
-void GameObject::setParent(GameObject* gameObject) { parent_ = gameObject; }
+void GameObject::setParent(GameObject* gameObject) {
+  parent_ = gameObject;
+  invalidateTransform();
+}
 GameObject* GameObject::getParent() const { return parent_; }
 
 void GameObject::setTexture(Texture* texture) { texture_ = texture; }
@@ -74,6 +176,17 @@ void GameObject::setActive(const bool active) {
 }
 bool GameObject::getActive() const { return active_; }
 
+bool GameObject::isReceivingEvents() const {
+  auto node = this;
+  while (node->parent_ != nullptr) {
+    if (!node->active_) return false;
+    node = node->parent_;
+  }
+
+  return node->active_ && scene_ != nullptr &&
+         scene_->getGameObject(node->handle_) == node;
+}
+
 void GameObject::setTransparent(const bool transparent) {
   transparent_ = transparent;
 }
@@ -82,38 +195,118 @@ bool GameObject::getTransparent() const { return transparent_; }
 
 void GameObject::setRenderable(bool renderable) { renderable_ = renderable; }
 
+void GameObject::setLayer(const int layer) { layer_ = layer; }
+
+int GameObject::getLayer() const { return layer_; }
+
+void GameObject::setConcurrent(const bool concurrent) {
+  concurrent_ = concurrent;
+}
+
+bool GameObject::getConcurrent() const { return concurrent_; }
+
+void GameObject::setUpdatePolicy(const UpdatePolicy policy,
+                                 const Uint32 interval) {
+  updatePolicy_ = policy;
+  updateInterval_ = interval > 0 ? interval : 1;
+}
+
+UpdatePolicy GameObject::getUpdatePolicy() const { return updatePolicy_; }
+
+Uint32 GameObject::getUpdateInterval() const { return updateInterval_; }
+
+void GameObject::requestUpdate() {
+  // The scene only schedules the roots of the trees
+  auto root = this;
+  while (root->parent_ != nullptr) root = root->parent_;
+  root->updateRequested_ = true;
+}
+
+bool GameObject::isUpdateRequested() const { return updateRequested_; }
+
+void GameObject::beginUpdate(const Uint64 step) {
+  updateSteps_ = lastUpdate_ == 0 || step <= lastUpdate_
+                     ? 1
+                     : static_cast<Uint32>(step - lastUpdate_);
+  lastUpdate_ = step;
+  updateRequested_ = false;
+}
+
+Uint32 GameObject::getUpdateSteps() const { return updateSteps_; }
+
+void GameObject::setVisibleFrame(const Uint64 frame) { visibleFrame_ = frame; }
+
+Uint64 GameObject::getVisibleFrame() const { return visibleFrame_; }
+
+void GameObject::setMoved(const bool moved) { moved_ = moved; }
+
+bool GameObject::getMoved() const { return moved_; }
+
 bool GameObject::getRenderable() const { return renderable_; }
 
-void GameObject::setSize(Vector2D<int> size) { size_ = size; }
+void GameObject::setSize(Vector2D<int> size) {
+  size_ = size;
+  invalidate();
+}
 Vector2D<int> GameObject::getSize() const { return size_; }
 
 void GameObject::setPosition(const Vector2D<int>& position) {
   position_ = position;
+  invalidateTransform();
+  invalidate();
 }
 Vector2D<int> GameObject::getPosition() const { return position_; }
 
+void GameObject::setScale(const Vector2D<double>& scale) {
+  scale_ = scale;
+  invalidateTransform();
+  invalidate();
+}
+Vector2D<double> GameObject::getScale() const { return scale_; }
+
+void GameObject::setRotation(const double rotation) {
+  rotation_ = rotation;
+  invalidateTransform();
+  invalidate();
+}
+double GameObject::getRotation() const { return rotation_; }
+
 bool GameObject::hasChildren() const { return !children_.empty(); }
-std::vector<GameObject*> GameObject::getChildren() const { return children_; }
+Span<GameObject* const> GameObject::getChildren() const { return children_; }
 
 void GameObject::addChild(GameObject* gameObject) {
   children_.push_back(gameObject);
   gameObject->setParent(this);
+  invalidate();
 }
 
 void GameObject::removeChild(GameObject* gameObject) {
   for (auto it = children_.begin(); it != children_.end(); ++it) {
     if (*it == gameObject) {
       children_.erase(it);
+      gameObject->setParent(nullptr);
       break;
     }
   }
+  invalidate();
 }
 
 void GameObject::destroy() { scene_->removeGameObject(this); }
 
+void GameObject::addTag(const std::string& tag) {
+  if (hasTag(tag)) return;
+  tags_.push_back(tag);
+  if (scene_ != nullptr) scene_->indexTag(this, tag);
+}
+
+bool GameObject::hasTag(const std::string& tag) const {
+  return std::find(tags_.begin(), tags_.end(), tag) != tags_.end();
+}
+
+const std::vector<std::string>& GameObject::getTags() const { return tags_; }
+
 GameObject* GameObject::clickScan(SDL_Point point) const {
-  const auto children = getChildren();
-  for (auto it = children.rbegin(); it != children.rend(); ++it) {
+  for (auto it = children_.rbegin(); it != children_.rend(); ++it) {
     const auto child = *it;
     if (child->clickScan(point)) return child;
   }
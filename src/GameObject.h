@@ -1,26 +1,115 @@
 #pragma once
+#include <string>
 #include <vector>
 
 #include "SDL.h"
+#include "SlotMap.h"
+#include "Span.h"
 #include "Vector2D.h"
 
 class Scene;
 class Texture;
 class EventListener;
 
+/**
+ * \brief When the scene updates a game object.
+ */
+enum class UpdatePolicy {
+  /**
+   * \brief Every simulation step.
+   */
+  ALWAYS,
+  /**
+   * \brief Every Nth step, the game objects sharing an interval being spread
+   * evenly over its steps.
+   */
+  INTERVAL,
+  /**
+   * \brief Every step while any of its tree was in view of the last frame.
+   */
+  VISIBLE,
+  /**
+   * \brief On the step after one of its tree's listeners ran, or after
+   * GameObject::requestUpdate().
+   */
+  EVENTS
+};
+
 class GameObject {
+ public:
+  typedef SlotMap<GameObject*>::handle_t handle_t;
+
+  /**
+   * \brief A transform in world space, the rotation in degrees clockwise.
+   */
+  typedef struct {
+    double x;
+    double y;
+    double scaleX;
+    double scaleY;
+    double rotation;
+  } transform_t;
+
  protected:
   bool awakened_ = false;
   bool active_ = true;
   bool transparent_ = false;
   bool renderable_ = true;
+  bool concurrent_ = false;
+  bool moved_ = false;
+  int layer_ = 0;
   Scene* scene_ = nullptr;
+
+  UpdatePolicy updatePolicy_ = UpdatePolicy::ALWAYS;
+  Uint32 updateInterval_ = 1;
+  bool updateRequested_ = false;
+  /**
+   * \brief The step of the last update, and how many steps it covered.
+   */
+  Uint64 lastUpdate_ = 0;
+  Uint32 updateSteps_ = 1;
+  /**
+   * \brief The last frame the tree was in view of.
+   */
+  Uint64 visibleFrame_ = 0;
+
+  /**
+   * \brief The transform relative to the parent, or to the world for the
+   * instances without one.
+   */
   Vector2D<int> position_;
+  Vector2D<double> scale_{1, 1};
+  double rotation_ = 0;
   Vector2D<int> size_;
   Texture* texture_;
   std::vector<EventListener*> eventListeners_;
   std::vector<GameObject*> children_;
   GameObject* parent_ = nullptr;
+  handle_t handle_{};
+  std::vector<std::string> tags_;
+
+  /**
+   * \brief The world transform and the tree's bounds, recomputed only after
+   * a change marked them dirty. A dirty transform implies dirty descendants,
+   * and dirty bounds imply dirty ancestors.
+   */
+  mutable transform_t world_{};
+  mutable SDL_Rect bounds_{};
+  mutable bool transformDirty_ = true;
+  mutable bool boundsDirty_ = true;
+
+  /**
+   * \brief Marks the world transform of this instance and its descendants
+   * dirty, stopping at the subtrees that already are.
+   */
+  void invalidateTransform();
+
+  /**
+   * \brief Marks the bounds of this instance and its ancestors dirty, and
+   * tells the scene the tree changed, so it is reindexed before the next
+   * spatial query.
+   */
+  void invalidate();
 
  public:
   GameObject(Scene* scene, Texture* texture);
@@ -31,27 +120,129 @@ class GameObject {
   virtual void render(SDL_Rect) const;
   virtual void render() const;
   virtual void update();
-  virtual void handleEvents(SDL_Event event);
   GameObject* addEventListener(EventListener* eventListener);
+  /**
+   * \return The rectangle drawn in world space, scaled but not rotated.
+   */
   virtual SDL_Rect getRect() const;
 
+  /**
+   * \brief Get the area covered by this instance and all of its children,
+   * cached until any of them changes.
+   * \return The union of every rectangle in the tree, rotated ones included.
+   */
+  SDL_Rect getBounds() const;
+
   Scene* getScene() const;
 
+  /**
+   * \brief Get the handle the scene tracks this instance with, which becomes
+   * stale once it is destroyed.
+   * \return The handle, or a null one if it was never added to a scene.
+   */
+  handle_t getHandle() const;
+  void setHandle(const handle_t& handle);
+
   void setActive(bool active);
   bool getActive() const;
 
+  /**
+   * \return Whether or not the listeners should receive events, which holds
+   * while this instance and its ancestors are active and its tree is part of
+   * the scene.
+   */
+  bool isReceivingEvents() const;
+
   void setTransparent(bool transparent);
   bool getTransparent() const;
 
   void setRenderable(bool renderable);
   bool getRenderable() const;
 
+  /**
+   * \brief Sets the layer the texture is drawn on, higher layers are drawn on
+   * top. Within a layer, draws are grouped by texture.
+   */
+  void setLayer(int layer);
+  int getLayer() const;
+
+  /**
+   * \brief Marks whether or not update() only touches this instance and its
+   * children, so the scene may run it on a worker thread alongside the other
+   * concurrent ones before updating the rest in order.
+   */
+  void setConcurrent(bool concurrent);
+  bool getConcurrent() const;
+
+  /**
+   * \brief Sets when the scene updates this instance, along with its whole
+   * tree. Only the policy of the tree's root is used.
+   * \param interval The steps between updates, for UpdatePolicy::INTERVAL.
+   */
+  void setUpdatePolicy(UpdatePolicy policy, Uint32 interval = 1);
+  UpdatePolicy getUpdatePolicy() const;
+  Uint32 getUpdateInterval() const;
+
+  /**
+   * \brief Asks for the tree to be updated on the next step, which wakes up
+   * the UpdatePolicy::EVENTS ones.
+   */
+  void requestUpdate();
+  bool isUpdateRequested() const;
+
+  /**
+   * \brief Records that the scene updates this instance on a step.
+   */
+  void beginUpdate(Uint64 step);
+
+  /**
+   * \brief Get how many simulation steps the current update covers, which
+   * is more than one for the game objects that skipped some, so they can
+   * advance by Scene::getTimeStep() times this.
+   * \return The steps since the last update.
+   */
+  Uint32 getUpdateSteps() const;
+
+  /**
+   * \brief Marks the tree as in view of a rendered frame.
+   */
+  void setVisibleFrame(Uint64 frame);
+  Uint64 getVisibleFrame() const;
+
+  /**
+   * \brief Marks whether or not the bounds changed since the scene last
+   * indexed this instance.
+   */
+  void setMoved(bool moved);
+  bool getMoved() const;
+
   void setSize(Vector2D<int> size);
   Vector2D<int> getSize() const;
 
+  /**
+   * \brief Sets the position relative to the parent, which moves every
+   * descendant along.
+   */
   void setPosition(const Vector2D<int>& position);
   Vector2D<int> getPosition() const;
 
+  void setScale(const Vector2D<double>& scale);
+  Vector2D<double> getScale() const;
+
+  /**
+   * \brief Sets the rotation relative to the parent, in degrees clockwise.
+   */
+  void setRotation(double rotation);
+  double getRotation() const;
+
+  /**
+   * \brief Get the transform after combining every ancestor's, which is
+   * only recomputed after this instance or an ancestor changed.
+   * \return The world transform.
+   */
+  const transform_t& getWorldTransform() const;
+  Vector2D<int> getWorldPosition() const;
+
   void setTexture(Texture* texture);
   Texture* getTexture() const;
 
@@ -60,11 +251,22 @@ class GameObject {
   GameObject* getParent() const;
 
   bool hasChildren() const;
-  std::vector<GameObject*> getChildren() const;
+  /**
+   * \return A view of the children, invalidated when they change.
+   */
+  Span<GameObject* const> getChildren() const;
   void addChild(GameObject* gameObject);
   void removeChild(GameObject* gameObject);
 
   void destroy();
 
+  /**
+   * \brief Labels this instance, so Scene::findByTag() finds it. Tags added
+   * after the scene created the instance are indexed right away.
+   */
+  void addTag(const std::string& tag);
+  bool hasTag(const std::string& tag) const;
+  const std::vector<std::string>& getTags() const;
+
   GameObject* clickScan(SDL_Point point) const;
 };
\ No newline at end of file
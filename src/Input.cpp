@@ -36,7 +36,7 @@ void Input::clear() {
   casted_ = nullptr;
 }
 
-void Input::update(const SDL_Event event) {
+void Input::update(const SDL_Event& event) {
   switch (event.type) {
     case SDL_KEYDOWN: {
       keyboard_ = SDL_GetKeyboardState(nullptr);
@@ -140,16 +140,8 @@ GameObject* Input::screenMouseToRay() {
   const auto position = input->mousePosition_;
   const auto point = SDL_Point{position.getX(), position.getY()};
   const auto scene = Game::getSceneMachine()->getCurrentScene();
-  const auto gameObjects = scene->getGameObjects();
-  for (auto it = gameObjects.rbegin(); it != gameObjects.rend(); ++it) {
-    const auto gameObject = *it;
-    const auto scanned = gameObject->clickScan(point);
-    if (scanned) {
-      input->casted_ = scanned;
-      return scanned;
-    }
-  }
-  return nullptr;
+  input->casted_ = scene->pick(scene->getCamera().toWorld(point));
+  return input->casted_;
 }
 
 bool Input::isMouseInside(const SDL_Rect* rectangle) {
@@ -87,7 +87,7 @@ class Input final {
    * \brief Update this instance from the event loop.
    * \param event The event to handle.
    */
-  void update(SDL_Event event);
+  void update(const SDL_Event& event);
 
   /**
    * \brief Gets the current mouse's position.
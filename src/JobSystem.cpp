@@ -0,0 +1,293 @@
+#include "JobSystem.h"
+
+#include <string>
+#include <utility>
+
+#include "Constants.h"
+#include "Profiler.h"
+
+namespace {
+/**
+ * \brief The index of the worker running on this thread, or -1 for threads
+ * that are not part of the pool.
+ */
+thread_local int currentWorker = -1;
+
+typedef struct {
+  JobSystem* system;
+  int index;
+} worker_data_t;
+
+/**
+ * \brief The pooled blocks no job is using, each one starting with a pointer
+ * to the next. It outlives the JobSystem, for the jobs still referenced then.
+ */
+void* freeBlocks = nullptr;
+SDL_SpinLock freeBlocksLock = 0;
+}  // namespace
+
+JobSystem* JobSystem::instance_ = nullptr;
+
+JobSystem::Job::Job() {
+  // The extra count is only released once the job is submitted, so it cannot
+  // start while its dependencies are being added
+  SDL_AtomicSet(&pending_, 1);
+}
+
+JobSystem::Worker::Worker() : mutex_(SDL_CreateMutex()) {}
+
+JobSystem::Worker::~Worker() { SDL_DestroyMutex(mutex_); }
+
+void JobSystem::Worker::push(JobSystem::job_t job) {
+  if (count_ == jobs_.size()) {
+    // Unrolled into a ring twice the size, the oldest job first
+    std::vector<job_t> jobs(jobs_.empty() ? 1 : jobs_.size() * 2);
+    for (size_t i = 0; i < count_; ++i) {
+      jobs[i] = std::move(jobs_[(head_ + i) % jobs_.size()]);
+    }
+    jobs_.swap(jobs);
+    head_ = 0;
+  }
+
+  jobs_[(head_ + count_) % jobs_.size()] = std::move(job);
+  ++count_;
+}
+
+JobSystem::job_t JobSystem::Worker::popNewest() {
+  if (count_ == 0) return nullptr;
+  --count_;
+  return std::move(jobs_[(head_ + count_) % jobs_.size()]);
+}
+
+JobSystem::job_t JobSystem::Worker::popOldest() {
+  if (count_ == 0) return nullptr;
+  auto job = std::move(jobs_[head_]);
+  head_ = (head_ + 1) % jobs_.size();
+  --count_;
+  return job;
+}
+
+JobSystem::JobSystem(const size_t workers)
+    : available_(SDL_CreateSemaphore(0)) {
+  SDL_AtomicSet(&running_, 1);
+  for (size_t i = 0; i < workers; ++i) workers_.push_back(new Worker());
+
+  // Threads are started once every queue exists, as they steal from all
+  for (size_t i = 0; i < workers; ++i) {
+    const auto name = "job-worker-" + std::to_string(i);
+    auto* data = new worker_data_t{this, static_cast<int>(i)};
+    workers_[i]->thread_ = SDL_CreateThread(runWorker, name.c_str(), data);
+  }
+}
+
+JobSystem::~JobSystem() {
+  SDL_AtomicSet(&running_, 0);
+  for (size_t i = 0; i < workers_.size(); ++i) SDL_SemPost(available_);
+
+  // Every thread is joined before any queue is freed, as they steal from all
+  for (auto* worker : workers_) SDL_WaitThread(worker->thread_, nullptr);
+  for (auto* worker : workers_) delete worker;
+  workers_.clear();
+
+  SDL_DestroySemaphore(available_);
+
+  // Blocks of the jobs still referenced return to the pool when they are freed
+  SDL_AtomicLock(&freeBlocksLock);
+  while (freeBlocks != nullptr) {
+    auto* block = freeBlocks;
+    freeBlocks = *static_cast<void**>(block);
+    ::operator delete(block);
+  }
+  SDL_AtomicUnlock(&freeBlocksLock);
+}
+
+int JobSystem::runWorker(void* data) {
+  const auto* workerData = static_cast<worker_data_t*>(data);
+  auto* system = workerData->system;
+  currentWorker = workerData->index;
+  delete workerData;
+  PROFILE_THREAD("job-worker-" + std::to_string(currentWorker));
+
+  while (SDL_AtomicGet(&system->running_)) {
+    // Every queued job posted once, but another thread may have taken it
+    SDL_SemWait(system->available_);
+    const auto job = system->take(currentWorker);
+    if (job) system->execute(job);
+  }
+
+  return 0;
+}
+
+void* JobSystem::allocate(const size_t size) {
+  if (size > JOB_BLOCK_SIZE) return ::operator new(size);
+
+  SDL_AtomicLock(&freeBlocksLock);
+  auto* block = freeBlocks;
+  if (block != nullptr) freeBlocks = *static_cast<void**>(block);
+  SDL_AtomicUnlock(&freeBlocksLock);
+
+  return block != nullptr ? block : ::operator new(JOB_BLOCK_SIZE);
+}
+
+void JobSystem::deallocate(void* block, const size_t size) {
+  if (size > JOB_BLOCK_SIZE) {
+    ::operator delete(block);
+    return;
+  }
+
+  SDL_AtomicLock(&freeBlocksLock);
+  *static_cast<void**>(block) = freeBlocks;
+  freeBlocks = block;
+  SDL_AtomicUnlock(&freeBlocksLock);
+}
+
+void JobSystem::enqueue(const JobSystem::job_t& job) {
+  auto index = currentWorker;
+  if (index < 0) {
+    const auto next = static_cast<size_t>(SDL_AtomicAdd(&next_, 1));
+    index = static_cast<int>(next % workers_.size());
+  }
+
+  auto* worker = workers_[static_cast<size_t>(index)];
+  SDL_LockMutex(worker->mutex_);
+  worker->push(job);
+  SDL_UnlockMutex(worker->mutex_);
+
+  SDL_SemPost(available_);
+}
+
+JobSystem::job_t JobSystem::take(const int worker) {
+  job_t job;
+
+  // The newest job of its own queue is the most likely to be in cache
+  if (worker >= 0) {
+    auto* own = workers_[static_cast<size_t>(worker)];
+    SDL_LockMutex(own->mutex_);
+    job = own->popNewest();
+    SDL_UnlockMutex(own->mutex_);
+    if (job) return job;
+  }
+
+  // Steal the oldest jobs of the others, starting from a different queue each
+  // time so the victims are spread
+  const auto size = workers_.size();
+  const auto start = static_cast<size_t>(SDL_AtomicAdd(&next_, 1));
+  for (size_t i = 0; i < size && !job; ++i) {
+    const auto index = (start + i) % size;
+    if (static_cast<int>(index) == worker) continue;
+
+    auto* victim = workers_[index];
+    SDL_LockMutex(victim->mutex_);
+    job = victim->popOldest();
+    SDL_UnlockMutex(victim->mutex_);
+  }
+
+  return job;
+}
+
+void JobSystem::execute(const JobSystem::job_t& job) {
+  PROFILE_ZONE("Job");
+  job->run();
+
+  // Marked under the lock, so no continuation is added after it is released
+  std::vector<job_t> continuations;
+  SDL_AtomicLock(&job->lock_);
+  SDL_AtomicSet(&job->done_, 1);
+  continuations.swap(job->continuations_);
+  SDL_AtomicUnlock(&job->lock_);
+
+  for (const auto& continuation : continuations) release(continuation);
+}
+
+void JobSystem::release(const JobSystem::job_t& job) {
+  if (SDL_AtomicAdd(&job->pending_, -1) == 1) enqueue(job);
+}
+
+void JobSystem::submit(const JobSystem::job_t& job,
+                       const std::vector<JobSystem::job_t>& dependencies) {
+  for (const auto& dependency : dependencies) {
+    if (!dependency) continue;
+
+    SDL_AtomicLock(&dependency->lock_);
+    if (!SDL_AtomicGet(&dependency->done_)) {
+      SDL_AtomicAdd(&job->pending_, 1);
+      dependency->continuations_.push_back(job);
+    }
+    SDL_AtomicUnlock(&dependency->lock_);
+  }
+
+  release(job);
+}
+
+bool JobSystem::isDone(const JobSystem::job_t& job) {
+  return !job || SDL_AtomicGet(&job->done_) != 0;
+}
+
+void JobSystem::help() {
+  const auto pending = take(currentWorker);
+  if (pending) {
+    execute(pending);
+  } else {
+    // The jobs waited for run elsewhere, let those threads have the core
+    SDL_Delay(0);
+  }
+}
+
+void JobSystem::wait(const JobSystem::job_t& job) {
+  while (!isDone(job)) help();
+}
+
+void JobSystem::wait(const std::vector<JobSystem::job_t>& jobs) {
+  for (const auto& job : jobs) wait(job);
+}
+
+void JobSystem::parallelFor(const size_t count, size_t batch,
+                            const std::function<void(size_t, size_t)>& body) {
+  if (count == 0) return;
+  if (batch == 0) batch = 1;
+
+  // The calling thread and one job per worker at most claim the batches in
+  // turn, so a large range does not schedule a job for each batch
+  const auto batches = (count + batch - 1) / batch;
+  const auto helpers =
+      batches - 1 < workers_.size() ? batches - 1 : workers_.size();
+  SDL_atomic_t next{};
+  SDL_atomic_t finished{};
+  const auto claim = [&]() {
+    while (true) {
+      const auto index = static_cast<size_t>(SDL_AtomicAdd(&next, 1));
+      if (index >= batches) return;
+      const auto begin = index * batch;
+      body(begin, begin + batch < count ? begin + batch : count);
+    }
+  };
+  for (size_t i = 0; i < helpers; ++i) {
+    schedule([&claim, &finished]() {
+      claim();
+      SDL_AtomicAdd(&finished, 1);
+    });
+  }
+
+  claim();
+
+  // The jobs use this frame until they finish, even with no batch left to them
+  while (static_cast<size_t>(SDL_AtomicGet(&finished)) < helpers) help();
+}
+
+size_t JobSystem::getWorkerCount() const { return workers_.size(); }
+
+JobSystem* JobSystem::getInstance() {
+  if (instance_ == nullptr) {
+    const auto cores = SDL_GetCPUCount();
+    instance_ = new JobSystem(cores > 2 ? static_cast<size_t>(cores - 1) : 1);
+  }
+
+  return instance_;
+}
+
+void JobSystem::destroy() {
+  if (instance_ != nullptr) {
+    delete instance_;
+    instance_ = nullptr;
+  }
+}
@@ -0,0 +1,245 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "SDL.h"
+#include "SDL_atomic.h"
+
+/**
+ * \brief The JobSystem class that runs small tasks on a pool with one worker
+ * thread per extra core. Every worker owns a queue it takes its newest jobs
+ * from, and steals the oldest jobs of the others when it runs out, so the
+ * load balances itself. Jobs may depend on other jobs, forming a graph that
+ * only schedules a job once everything it depends on finished.
+ *
+ * \note Threads that wait for a job run other pending jobs meanwhile, so
+ * waiting from inside a job does not deadlock the pool.
+ * \note Jobs are allocated from a pool of blocks and queued on ring buffers,
+ * so scheduling the same jobs every step does not allocate once warm.
+ */
+class JobSystem final {
+  class Job {
+   public:
+    Job();
+    virtual ~Job() = default;
+    Job(const Job&) = delete;             // Copy Constructor
+    Job(Job&&) = delete;                  // Move Constructor
+    Job& operator=(const Job&) = delete;  // Assignment Operator
+    Job& operator=(Job&&) = delete;       // Move Operator
+
+    virtual void run() = 0;
+
+    /**
+     * \brief The amount of dependencies left, plus one until it is
+     * submitted. The job is queued when it reaches zero.
+     */
+    SDL_atomic_t pending_{};
+    SDL_atomic_t done_{};
+
+    /**
+     * \brief Guards the continuations, which are the jobs that depend on this
+     * one and are released once it is done.
+     */
+    SDL_SpinLock lock_ = 0;
+    std::vector<std::shared_ptr<Job>> continuations_{};
+  };
+
+  /**
+   * \brief A job that stores its callable inline, so it needs no separate
+   * allocation the way an std::function capturing more than a pointer does.
+   */
+  template <typename F>
+  class Task final : public Job {
+   public:
+    explicit Task(F task) : task_(std::move(task)) {}
+
+    void run() override { task_(); }
+
+   private:
+    F task_;
+  };
+
+  /**
+   * \brief The allocator of the jobs, which takes their memory from the pool.
+   */
+  template <typename T>
+  class Allocator {
+   public:
+    typedef T value_type;
+
+    Allocator() = default;
+    template <typename U>
+    explicit Allocator(const Allocator<U>&) {}
+
+    T* allocate(const size_t count) {
+      return static_cast<T*>(JobSystem::allocate(count * sizeof(T)));
+    }
+
+    void deallocate(T* block, const size_t count) {
+      JobSystem::deallocate(block, count * sizeof(T));
+    }
+
+    friend bool operator==(const Allocator&, const Allocator&) { return true; }
+    friend bool operator!=(const Allocator&, const Allocator&) {
+      return false;
+    }
+  };
+
+ public:
+  typedef std::shared_ptr<Job> job_t;
+
+ private:
+  class Worker {
+   public:
+    Worker();
+    ~Worker();
+    Worker(const Worker&) = delete;             // Copy Constructor
+    Worker(Worker&&) = delete;                  // Move Constructor
+    Worker& operator=(const Worker&) = delete;  // Assignment Operator
+    Worker& operator=(Worker&&) = delete;       // Move Operator
+
+    /**
+     * \brief Queues a job as the newest one.
+     */
+    void push(job_t job);
+
+    /**
+     * \return The newest job, or nullptr when the queue is empty.
+     */
+    job_t popNewest();
+
+    /**
+     * \return The oldest job, or nullptr when the queue is empty.
+     */
+    job_t popOldest();
+
+    SDL_Thread* thread_ = nullptr;
+    SDL_mutex* mutex_ = nullptr;
+
+   private:
+    /**
+     * \brief The queued jobs, a ring buffer that starts at the oldest one and
+     * only grows when it is full.
+     */
+    std::vector<job_t> jobs_{};
+    size_t head_ = 0;
+    size_t count_ = 0;
+  };
+
+  static JobSystem* instance_;
+
+  std::vector<Worker*> workers_{};
+  SDL_atomic_t running_{};
+  SDL_atomic_t next_{};
+
+  /**
+   * \brief Counts the queued jobs, so idle workers sleep instead of spinning.
+   */
+  SDL_sem* available_ = nullptr;
+
+  explicit JobSystem(size_t workers);
+
+  static int runWorker(void* data);
+
+  /**
+   * \brief Takes a block for a job from the pool, or from the heap when the
+   * pool is empty or the job does not fit a block.
+   */
+  static void* allocate(size_t size);
+
+  /**
+   * \brief Returns a job's block to the pool, or to the heap when it did not
+   * fit one.
+   */
+  static void deallocate(void* block, size_t size);
+
+  /**
+   * \brief Queues a job whose dependencies are all done, on the calling
+   * worker's own queue or on the next one in turn for any other thread.
+   */
+  void enqueue(const job_t& job);
+
+  /**
+   * \brief Takes a job, from the given worker's newest end first, and from
+   * the other queues' oldest ends otherwise.
+   * \param worker The index of the calling worker, or -1 for other threads.
+   */
+  job_t take(int worker);
+
+  void execute(const job_t& job);
+
+  /**
+   * \brief Runs one pending job while waiting for others, or lets another
+   * thread have the core when there is none.
+   */
+  void help();
+
+  /**
+   * \brief Drops one of the job's pending counts, queueing it at zero.
+   */
+  void release(const job_t& job);
+
+  /**
+   * \brief Adds a new job as a continuation of the dependencies that are not
+   * done yet, queueing it if there is none.
+   */
+  void submit(const job_t& job, const std::vector<job_t>& dependencies);
+
+ public:
+  ~JobSystem();
+  JobSystem(const JobSystem&) = delete;             // Copy Constructor
+  JobSystem(JobSystem&&) = delete;                  // Move Constructor
+  JobSystem& operator=(const JobSystem&) = delete;  // Assignment Operator
+  JobSystem& operator=(JobSystem&&) = delete;       // Move Operator
+
+  /**
+   * \brief Schedules a task to run on the pool.
+   * \param task The function to run.
+   * \param dependencies The jobs that must be done before this one starts.
+   * \return The job, to wait for it or to depend on it.
+   */
+  template <typename F>
+  job_t schedule(F task, const std::vector<job_t>& dependencies = {}) {
+    const job_t job =
+        std::allocate_shared<Task<F>>(Allocator<Task<F>>(), std::move(task));
+    submit(job, dependencies);
+    return job;
+  }
+
+  /**
+   * \return Whether or not the job finished running.
+   */
+  static bool isDone(const job_t& job);
+
+  /**
+   * \brief Blocks until the job is done, running pending jobs meanwhile.
+   */
+  void wait(const job_t& job);
+
+  /**
+   * \brief Blocks until every job is done, running pending jobs meanwhile.
+   */
+  void wait(const std::vector<job_t>& jobs);
+
+  /**
+   * \brief Splits a range into batches and runs them on the pool, including
+   * the calling thread, returning once all of them are done. The batches are
+   * claimed by up to one job per worker, rather than one job each.
+   * \param count The amount of items.
+   * \param batch The amount of items each job processes.
+   * \param body The function to run with the [begin, end) range of a batch.
+   */
+  void parallelFor(size_t count, size_t batch,
+                   const std::function<void(size_t, size_t)>& body);
+
+  /**
+   * \return The amount of worker threads.
+   */
+  size_t getWorkerCount() const;
+
+  static JobSystem* getInstance();
+  static void destroy();
+};
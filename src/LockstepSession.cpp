@@ -0,0 +1,176 @@
+#include "LockstepSession.h"
+
+LockstepSession::LockstepSession() : mutex_(SDL_CreateMutex()) {}
+
+LockstepSession::~LockstepSession() { SDL_DestroyMutex(mutex_); }
+
+LockstepSession::frame_t& LockstepSession::getFrame(const Uint32 frame) {
+  auto& entry = frames_[frame % WINDOW];
+
+  // The slot is reused, drop what was left from the frame a window ago
+  if (entry.frame != frame) entry = {frame, 0, {}};
+  return entry;
+}
+
+bool LockstepSession::store(const Uint32 frame, const Uint8 peer,
+                            const LockstepSession::input_t& input) {
+  if (!active_ || peer >= peers_) return false;
+  if (frame < frame_ || frame >= frame_ + WINDOW) return false;
+
+  auto& entry = getFrame(frame);
+  entry.inputs[peer] = input;
+  entry.received |= 1u << peer;
+  return true;
+}
+
+void LockstepSession::start(const Uint8 slot, const Uint8 peers) {
+  if (SDL_LockMutex(mutex_) != 0) return;
+
+  active_ = true;
+  desynced_ = false;
+  slot_ = slot;
+  peers_ = static_cast<Uint8>(SDL_min(peers, LOCKSTEP_MAX_PEERS));
+  frame_ = 0;
+  inputFrame_ = LOCKSTEP_INPUT_DELAY;
+  desyncFrame_ = 0;
+
+  const auto everyone = (1u << peers_) - 1u;
+  for (Uint32 i = 0; i < WINDOW; ++i) {
+    frames_[i] = {i, i < inputFrame_ ? everyone : 0, {}};
+  }
+
+  SDL_UnlockMutex(mutex_);
+}
+
+void LockstepSession::stop() {
+  if (SDL_LockMutex(mutex_) == 0) {
+    active_ = false;
+    SDL_UnlockMutex(mutex_);
+  }
+}
+
+bool LockstepSession::isActive() const {
+  bool active = false;
+  if (SDL_LockMutex(mutex_) == 0) {
+    active = active_;
+    SDL_UnlockMutex(mutex_);
+  }
+  return active;
+}
+
+bool LockstepSession::submit(const LockstepSession::input_t& input,
+                             Uint32& frame) {
+  if (SDL_LockMutex(mutex_) != 0) return false;
+
+  // Every frame needs a local input, but they never run further ahead than
+  // LOCKSTEP_INPUT_DELAY frames, so a stalled simulation stops sending them
+  const auto stored = inputFrame_ <= frame_ + LOCKSTEP_INPUT_DELAY &&
+                      store(inputFrame_, slot_, input);
+  if (stored) frame = inputFrame_++;
+
+  SDL_UnlockMutex(mutex_);
+  return stored;
+}
+
+bool LockstepSession::receive(const Uint32 frame, const Uint8 peer,
+                              const LockstepSession::input_t& input) {
+  // The local inputs were already stored when they were submitted
+  if (SDL_LockMutex(mutex_) != 0) return false;
+  const auto stored = peer != slot_ && store(frame, peer, input);
+  SDL_UnlockMutex(mutex_);
+  return stored;
+}
+
+bool LockstepSession::canAdvance() const {
+  bool ready = false;
+  if (SDL_LockMutex(mutex_) == 0) {
+    const auto& entry = frames_[frame_ % WINDOW];
+    ready = active_ && entry.frame == frame_ &&
+            entry.received == (1u << peers_) - 1u;
+    SDL_UnlockMutex(mutex_);
+  }
+  return ready;
+}
+
+bool LockstepSession::advance(Uint32& frame,
+                              LockstepSession::frame_inputs_t& inputs) {
+  if (SDL_LockMutex(mutex_) != 0) return false;
+
+  const auto& entry = frames_[frame_ % WINDOW];
+  const auto ready = active_ && entry.frame == frame_ &&
+                     entry.received == (1u << peers_) - 1u;
+  if (ready) {
+    frame = frame_++;
+    inputs = entry.inputs;
+  }
+
+  SDL_UnlockMutex(mutex_);
+  return ready;
+}
+
+void LockstepSession::desync(const Uint32 frame) {
+  if (SDL_LockMutex(mutex_) == 0) {
+    if (!desynced_) desyncFrame_ = frame;
+    desynced_ = true;
+    SDL_UnlockMutex(mutex_);
+  }
+}
+
+bool LockstepSession::isDesynced() const {
+  bool desynced = false;
+  if (SDL_LockMutex(mutex_) == 0) {
+    desynced = desynced_;
+    SDL_UnlockMutex(mutex_);
+  }
+  return desynced;
+}
+
+Uint32 LockstepSession::getDesyncFrame() const {
+  Uint32 frame = 0;
+  if (SDL_LockMutex(mutex_) == 0) {
+    frame = desyncFrame_;
+    SDL_UnlockMutex(mutex_);
+  }
+  return frame;
+}
+
+Uint8 LockstepSession::getSlot() const {
+  Uint8 slot = 0;
+  if (SDL_LockMutex(mutex_) == 0) {
+    slot = slot_;
+    SDL_UnlockMutex(mutex_);
+  }
+  return slot;
+}
+
+Uint8 LockstepSession::getPeers() const {
+  Uint8 peers = 0;
+  if (SDL_LockMutex(mutex_) == 0) {
+    peers = peers_;
+    SDL_UnlockMutex(mutex_);
+  }
+  return peers;
+}
+
+Uint32 LockstepSession::getFrame() const {
+  Uint32 frame = 0;
+  if (SDL_LockMutex(mutex_) == 0) {
+    frame = frame_;
+    SDL_UnlockMutex(mutex_);
+  }
+  return frame;
+}
+
+bool LockstepSession::isChecksumFrame(const Uint32 frame) {
+  return frame % LOCKSTEP_CHECKSUM_INTERVAL == 0;
+}
+
+Uint32 LockstepSession::checksum(const void* data, const size_t length,
+                                 Uint32 hash) {
+  const auto* bytes = static_cast<const Uint8*>(data);
+  for (size_t i = 0; i < length; ++i) {
+    hash ^= bytes[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
@@ -0,0 +1,198 @@
+#pragma once
+#include <array>
+#include <functional>
+
+#include "Constants.h"
+#include "SDL.h"
+
+/**
+ * \brief The LockstepSession class that buffers the input commands of every
+ * peer in a deterministic lockstep match. Local inputs are scheduled
+ * LOCKSTEP_INPUT_DELAY frames ahead so they reach the other peers in time, and
+ * a frame may only be simulated once the inputs of every peer arrived for it.
+ *
+ * \note Inputs are received from the network thread, while the game loop
+ * submits its own and advances the simulation.
+ */
+class LockstepSession final {
+ public:
+  typedef struct {
+    /**
+     * \brief The bitmask of the pressed buttons.
+     */
+    Uint8 buttons;
+    /**
+     * \brief The aim direction, in 1/65536ths of a turn, kept integral so
+     * every peer simulates the exact same value.
+     */
+    Uint16 aim;
+  } input_t;
+
+  enum Button : Uint8 {
+    UP = 1u << 0u,
+    DOWN = 1u << 1u,
+    LEFT = 1u << 2u,
+    RIGHT = 1u << 3u,
+    SHOOT = 1u << 4u
+  };
+
+  typedef std::array<input_t, LOCKSTEP_MAX_PEERS> frame_inputs_t;
+
+  /**
+   * \brief Simulates a frame with the input of every peer, indexed by slot.
+   * \return The checksum of the state after simulating it.
+   */
+  typedef std::function<Uint32(Uint32 frame, const frame_inputs_t& inputs)>
+      simulate_t;
+
+ private:
+  /**
+   * \brief The amount of frames buffered ahead of the simulation.
+   */
+  static const Uint32 WINDOW = 64;
+
+  typedef struct {
+    Uint32 frame;
+    /**
+     * \brief The bitmask of the peers whose input arrived.
+     */
+    Uint32 received;
+    frame_inputs_t inputs;
+  } frame_t;
+
+  SDL_mutex* mutex_ = nullptr;
+  std::array<frame_t, WINDOW> frames_{};
+  bool active_ = false;
+  bool desynced_ = false;
+  Uint8 slot_ = 0;
+  Uint8 peers_ = 0;
+
+  /**
+   * \brief The next frame to simulate.
+   */
+  Uint32 frame_ = 0;
+
+  /**
+   * \brief The next frame a local input is scheduled for.
+   */
+  Uint32 inputFrame_ = 0;
+
+  /**
+   * \brief The first frame the checksums disagreed on, if desynced.
+   */
+  Uint32 desyncFrame_ = 0;
+
+  frame_t& getFrame(Uint32 frame);
+
+  bool store(Uint32 frame, Uint8 peer, const input_t& input);
+
+ public:
+  LockstepSession();
+  ~LockstepSession();
+  LockstepSession(const LockstepSession&) = delete;  // Copy Constructor
+  LockstepSession(LockstepSession&&) = delete;       // Move Constructor
+  LockstepSession& operator=(const LockstepSession&) =
+      delete;  // Assignment Operator
+  LockstepSession& operator=(LockstepSession&&) = delete;  // Move Operator
+
+  /**
+   * \brief Starts a new match, dropping every buffered input. The first
+   * LOCKSTEP_INPUT_DELAY frames are filled with empty inputs, as nobody could
+   * have sent any for them.
+   * \param slot The local peer's slot, assigned by the server.
+   * \param peers The amount of peers in the match.
+   */
+  void start(Uint8 slot, Uint8 peers);
+
+  /**
+   * \brief Stops the match, inputs received afterwards are ignored.
+   */
+  void stop();
+
+  /**
+   * \return Whether or not a match is running.
+   */
+  bool isActive() const;
+
+  /**
+   * \brief Schedules the local input for the next free frame.
+   * \param input The local peer's input.
+   * \param frame The frame the input was scheduled for, which must be sent to
+   * the other peers.
+   * \return Whether or not the input was scheduled, false if no match is
+   * running or the local inputs are already LOCKSTEP_INPUT_DELAY frames ahead
+   * of the simulation.
+   */
+  bool submit(const input_t& input, Uint32& frame);
+
+  /**
+   * \brief Stores an input relayed by the server.
+   * \param frame The frame the input is for.
+   * \param peer The slot of the peer that sent it.
+   * \param input The peer's input.
+   * \return Whether or not the input was stored.
+   */
+  bool receive(Uint32 frame, Uint8 peer, const input_t& input);
+
+  /**
+   * \return Whether or not the inputs of every peer arrived for the next
+   * frame.
+   */
+  bool canAdvance() const;
+
+  /**
+   * \brief Takes the inputs of the next frame, if all of them arrived.
+   * \param frame The frame that must be simulated next.
+   * \param inputs The input of every peer, indexed by slot.
+   * \return Whether or not the frame can be simulated.
+   */
+  bool advance(Uint32& frame, frame_inputs_t& inputs);
+
+  /**
+   * \brief Marks the match as desynchronized, as reported by the server.
+   * \param frame The first frame the checksums disagreed on.
+   */
+  void desync(Uint32 frame);
+
+  /**
+   * \return Whether or not the peers' simulations diverged.
+   */
+  bool isDesynced() const;
+
+  /**
+   * \return The first frame the checksums disagreed on.
+   */
+  Uint32 getDesyncFrame() const;
+
+  /**
+   * \return The local peer's slot.
+   */
+  Uint8 getSlot() const;
+
+  /**
+   * \return The amount of peers in the match.
+   */
+  Uint8 getPeers() const;
+
+  /**
+   * \return The next frame to simulate.
+   */
+  Uint32 getFrame() const;
+
+  /**
+   * \brief Whether or not the state after simulating a frame should be
+   * checksummed and sent, every LOCKSTEP_CHECKSUM_INTERVAL frames.
+   */
+  static bool isChecksumFrame(Uint32 frame);
+
+  /**
+   * \brief Hashes the bytes of a state with FNV-1a, chaining a previous hash
+   * so a whole state can be hashed in parts.
+   * \param data The bytes to hash, which must not contain padding.
+   * \param length The amount of bytes.
+   * \param hash The previous hash, or the FNV offset basis to start a new one.
+   * \return The new hash.
+   */
+  static Uint32 checksum(const void* data, size_t length,
+                         Uint32 hash = 2166136261u);
+};
@@ -0,0 +1,18 @@
+#include "MovementSystem.h"
+
+#include "Components.h"
+#include "World.h"
+
+void MovementSystem::update(World& world, const double step) {
+  const auto seconds = static_cast<float>(step);
+  world.each<position_t, velocity_t>(
+      [seconds](const World::entity_t&, position_t& position,
+                const velocity_t& velocity) {
+        position.previousX = position.x;
+        position.previousY = position.y;
+        position.x += velocity.x * seconds;
+        position.y += velocity.y * seconds;
+      });
+}
+
+bool MovementSystem::isConcurrent() const { return true; }
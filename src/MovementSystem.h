@@ -0,0 +1,12 @@
+#pragma once
+#include "System.h"
+
+/**
+ * \brief The MovementSystem class that moves every entity with a position and
+ * a velocity.
+ */
+class MovementSystem final : public System {
+ public:
+  void update(World& world, double step) override;
+  bool isConcurrent() const override;
+};
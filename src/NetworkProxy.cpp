@@ -0,0 +1,245 @@
+#include "NetworkProxy.h"
+
+#include <algorithm>
+
+#include "Clock.h"
+#include "SDLError.h"
+
+NetworkProxy::Link::Link(const settings_t& settings, std::mt19937& random)
+    : settings_(settings), random_(random) {}
+
+void NetworkProxy::Link::push(const char* data, const int length,
+                              const Uint64 now) {
+  std::uniform_real_distribution<double> chance(0.0, 1.0);
+  auto release = now + static_cast<Uint64>(settings_.latency) * 1000u;
+  if (settings_.jitter != 0) {
+    std::uniform_int_distribution<Uint32> jitter(0, settings_.jitter * 1000u);
+    release += jitter(random_);
+  }
+
+  if (settings_.loss > 0 && chance(random_) < settings_.loss) {
+    release += static_cast<Uint64>(settings_.retransmit) * 1000u;
+    ++stats_.lost;
+  }
+
+  if (settings_.reorder > 0 && chance(random_) < settings_.reorder) {
+    release += static_cast<Uint64>(settings_.reorderGap) * 1000u;
+    ++stats_.reordered;
+  }
+
+  // TCP delivers in order, so a held back chunk stalls the ones behind it
+  release = std::max(release, lastRelease_);
+
+  // Serialize the chunk through the capped link
+  if (settings_.bandwidth != 0) {
+    const auto start = std::max(release, busyUntil_);
+    busyUntil_ = start + static_cast<Uint64>(length) * 1000000u /
+                             static_cast<Uint64>(settings_.bandwidth);
+    release = busyUntil_;
+  }
+
+  lastRelease_ = release;
+  stats_.bytes += static_cast<Uint64>(length);
+  ++stats_.chunks;
+  stats_.delay += release - now;
+  queue_.push_back({release, std::vector<char>(data, data + length)});
+}
+
+bool NetworkProxy::Link::flush(TCPsocket destination, const Uint64 now) {
+  while (!queue_.empty() && queue_.front().release <= now) {
+    const auto& chunk = queue_.front();
+    const auto length = static_cast<int>(chunk.data.size());
+    if (SDLNet_TCP_Send(destination, chunk.data.data(), length) < length)
+      return false;
+    queue_.pop_front();
+  }
+
+  return true;
+}
+
+Uint64 NetworkProxy::Link::getNextRelease() const {
+  return queue_.empty() ? 0 : queue_.front().release;
+}
+
+NetworkProxy::Connection::Connection(TCPsocket client, TCPsocket server,
+                                     const settings_t& settings,
+                                     std::mt19937& random)
+    : client_(client),
+      server_(server),
+      upstream_(settings, random),
+      downstream_(settings, random) {}
+
+NetworkProxy::NetworkProxy(const settings_t& settings, const Uint32 seed)
+    : settings_(settings), random_(seed) {
+  if (SDL_Init(0) == -1) {
+    throw SDLError(std::string("SDL_Init: ") + SDL_GetError());
+  }
+
+  if (SDLNet_Init() == -1) {
+    throw SDLError(std::string("SDLNet_Init: ") + SDLNet_GetError());
+  }
+}
+
+NetworkProxy::~NetworkProxy() {
+  for (auto connection : connections_) {
+    SDLNet_TCP_Close(connection->client_);
+    SDLNet_TCP_Close(connection->server_);
+    delete connection;
+  }
+  connections_.clear();
+
+  if (socketSet_ != nullptr) SDLNet_FreeSocketSet(socketSet_);
+  if (listener_ != nullptr) SDLNet_TCP_Close(listener_);
+
+  SDLNet_Quit();
+  SDL_Quit();
+}
+
+void NetworkProxy::open(const Uint16 port, const std::string& host,
+                        const Uint16 targetPort) {
+  IPaddress ip{};
+  if (SDLNet_ResolveHost(&ip, nullptr, port) == -1 ||
+      SDLNet_ResolveHost(&target_, host.c_str(), targetPort) == -1) {
+    throw SDLError(std::string("SDLNet_ResolveHost: ") + SDLNet_GetError());
+  }
+
+  listener_ = SDLNet_TCP_Open(&ip);
+  if (!listener_) {
+    throw SDLError(std::string("SDLNet_TCP_Open: ") + SDLNet_GetError());
+  }
+
+  rebuildSocketSet();
+  printf(
+      "time_ms,direction,bytes_per_second,chunks,lost,reordered,delay_ms\n");
+}
+
+void NetworkProxy::run(const Uint32 duration) {
+  const auto start = Clock::microseconds();
+  auto nextReport = start + 1000000u;
+
+  while (true) {
+    const auto now = Clock::microseconds();
+    if (duration != 0 && now - start >= static_cast<Uint64>(duration) * 1000u)
+      break;
+
+    // Sleep until the next release is due, or until any socket is readable
+    Uint64 wake = nextReport;
+    for (const auto connection : connections_) {
+      const auto up = connection->upstream_.getNextRelease();
+      const auto down = connection->downstream_.getNextRelease();
+      if (up != 0) wake = std::min(wake, up);
+      if (down != 0) wake = std::min(wake, down);
+    }
+    const auto timeout =
+        wake > now ? static_cast<Uint32>((wake - now) / 1000u) : 0;
+    SDLNet_CheckSockets(socketSet_, timeout);
+
+    if (SDLNet_SocketReady(listener_)) accept();
+
+    const auto current = Clock::microseconds();
+    auto changed = false;
+    for (auto connection : connections_) {
+      if (!forward(connection->client_, connection->upstream_, current) ||
+          !forward(connection->server_, connection->downstream_, current) ||
+          !connection->upstream_.flush(connection->server_, current) ||
+          !connection->downstream_.flush(connection->client_, current)) {
+        connection->closed_ = true;
+        changed = true;
+      }
+    }
+
+    if (changed) {
+      auto it = connections_.begin();
+      while (it != connections_.end()) {
+        auto connection = *it;
+        if (connection->closed_) {
+          SDLNet_TCP_Close(connection->client_);
+          SDLNet_TCP_Close(connection->server_);
+          delete connection;
+          it = connections_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      rebuildSocketSet();
+    }
+
+    if (current >= nextReport) {
+      report(current - start, current - nextReport + 1000000u);
+      nextReport = current + 1000000u;
+    }
+  }
+}
+
+void NetworkProxy::accept() {
+  auto client = SDLNet_TCP_Accept(listener_);
+  if (!client) return;
+
+  auto server = SDLNet_TCP_Open(&target_);
+  if (!server) {
+    printf("SDLNet_TCP_Open: %s\n", SDLNet_GetError());
+    SDLNet_TCP_Close(client);
+    return;
+  }
+
+  connections_.push_back(new Connection(client, server, settings_, random_));
+  rebuildSocketSet();
+}
+
+void NetworkProxy::rebuildSocketSet() {
+  if (socketSet_ != nullptr) SDLNet_FreeSocketSet(socketSet_);
+  socketSet_ =
+      SDLNet_AllocSocketSet(static_cast<int>(connections_.size() * 2 + 1));
+  SDLNet_TCP_AddSocket(socketSet_, listener_);
+  for (const auto connection : connections_) {
+    SDLNet_TCP_AddSocket(socketSet_, connection->client_);
+    SDLNet_TCP_AddSocket(socketSet_, connection->server_);
+  }
+}
+
+bool NetworkProxy::forward(TCPsocket source, Link& link, const Uint64 now) {
+  if (!SDLNet_SocketReady(source)) return true;
+
+  char buffer[4096];
+  const auto length = SDLNet_TCP_Recv(source, buffer, sizeof buffer);
+  if (length <= 0) return false;
+
+  link.push(buffer, length, now);
+  return true;
+}
+
+void NetworkProxy::report(const Uint64 now, const Uint64 elapsed) {
+  link_stats_t upstream{};
+  link_stats_t downstream{};
+  for (auto connection : connections_) {
+    const auto& up = connection->upstream_.stats_;
+    const auto& down = connection->downstream_.stats_;
+    upstream = {upstream.bytes + up.bytes, upstream.chunks + up.chunks,
+                upstream.lost + up.lost, upstream.reordered + up.reordered,
+                upstream.delay + up.delay};
+    downstream = {downstream.bytes + down.bytes,
+                  downstream.chunks + down.chunks, downstream.lost + down.lost,
+                  downstream.reordered + down.reordered,
+                  downstream.delay + down.delay};
+    connection->upstream_.stats_ = {};
+    connection->downstream_.stats_ = {};
+  }
+
+  const auto seconds = static_cast<double>(elapsed) / 1000000.0;
+  const char* names[] = {"up", "down"};
+  const link_stats_t* totals[] = {&upstream, &downstream};
+  for (size_t i = 0; i < 2; ++i) {
+    const auto& stats = *totals[i];
+    const auto delay =
+        stats.chunks == 0 ? 0.0
+                          : static_cast<double>(stats.delay) /
+                                static_cast<double>(stats.chunks) / 1000.0;
+    printf("%llu,%s,%.0f,%llu,%llu,%llu,%.3f\n",
+           static_cast<unsigned long long>(now / 1000u), names[i],
+           static_cast<double>(stats.bytes) / seconds,
+           static_cast<unsigned long long>(stats.chunks),
+           static_cast<unsigned long long>(stats.lost),
+           static_cast<unsigned long long>(stats.reordered), delay);
+  }
+  fflush(stdout);
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "SDL.h"
+#include "SDL_net.h"
+
+/**
+ * \brief The NetworkProxy that sits between the game clients and the server,
+ * forwarding every connection while impairing it with latency, jitter, loss,
+ * reordering and bandwidth caps.
+ *
+ * \note The game protocol runs over TCP, which delivers bytes in order. Loss
+ * and reordering are therefore emulated the way TCP surfaces them to the game:
+ * the affected chunk is held back (for a retransmission or for the reordering
+ * gap), and everything sent after it waits behind it.
+ */
+class NetworkProxy final {
+ public:
+  typedef struct {
+    /**
+     * \brief The fixed one-way delay added to every chunk, in milliseconds.
+     */
+    Uint32 latency;
+    /**
+     * \brief The maximum random delay added on top of the latency, in
+     * milliseconds.
+     */
+    Uint32 jitter;
+    /**
+     * \brief The probability, from 0 to 1, that a chunk is lost.
+     */
+    double loss;
+    /**
+     * \brief The delay before a lost chunk is retransmitted, in milliseconds.
+     */
+    Uint32 retransmit;
+    /**
+     * \brief The probability, from 0 to 1, that a chunk arrives out of order.
+     */
+    double reorder;
+    /**
+     * \brief The time a reordered chunk is held back, in milliseconds.
+     */
+    Uint32 reorderGap;
+    /**
+     * \brief The link capacity in bytes per second, or 0 for no cap.
+     */
+    Uint32 bandwidth;
+  } settings_t;
+
+  typedef struct {
+    Uint64 bytes;
+    Uint64 chunks;
+    Uint64 lost;
+    Uint64 reordered;
+    /**
+     * \brief The sum of the delays added to each chunk, in microseconds.
+     */
+    Uint64 delay;
+  } link_stats_t;
+
+ private:
+  /**
+   * \brief One direction of a proxied connection.
+   */
+  class Link {
+    typedef struct {
+      Uint64 release;
+      std::vector<char> data;
+    } chunk_t;
+
+    const settings_t& settings_;
+    std::mt19937& random_;
+    std::deque<chunk_t> queue_{};
+    Uint64 lastRelease_ = 0;
+    Uint64 busyUntil_ = 0;
+
+   public:
+    link_stats_t stats_{};
+
+    Link(const settings_t& settings, std::mt19937& random);
+
+    /**
+     * \brief Schedules a chunk read from the source socket.
+     * \param data The bytes read.
+     * \param length The amount of bytes read.
+     * \param now The current time in microseconds.
+     */
+    void push(const char* data, int length, Uint64 now);
+
+    /**
+     * \brief Writes every chunk whose release time has passed.
+     * \param destination The socket to write into.
+     * \param now The current time in microseconds.
+     * \return Whether or not the destination is still writable.
+     */
+    bool flush(TCPsocket destination, Uint64 now);
+
+    /**
+     * \return The release time of the next chunk, or 0 if the queue is empty.
+     */
+    Uint64 getNextRelease() const;
+  };
+
+  class Connection {
+   public:
+    TCPsocket client_;
+    TCPsocket server_;
+    Link upstream_;
+    Link downstream_;
+    bool closed_ = false;
+
+    Connection(TCPsocket client, TCPsocket server, const settings_t& settings,
+               std::mt19937& random);
+  };
+
+  settings_t settings_;
+  std::mt19937 random_;
+  IPaddress target_{};
+  TCPsocket listener_ = nullptr;
+  SDLNet_SocketSet socketSet_ = nullptr;
+  std::vector<Connection*> connections_{};
+
+  void accept();
+  void rebuildSocketSet();
+  bool forward(TCPsocket source, Link& link, Uint64 now);
+  void report(Uint64 now, Uint64 elapsed);
+
+ public:
+  /**
+   * \brief Create a new proxy.
+   * \param settings The impairments applied to both directions.
+   * \param seed The seed for every random decision, for repeatable runs.
+   */
+  NetworkProxy(const settings_t& settings, Uint32 seed);
+  ~NetworkProxy();
+  NetworkProxy(const NetworkProxy&) = delete;             // Copy Constructor
+  NetworkProxy(NetworkProxy&&) = delete;                  // Move Constructor
+  NetworkProxy& operator=(const NetworkProxy&) = delete;  // Assignment Operator
+  NetworkProxy& operator=(NetworkProxy&&) = delete;       // Move Operator
+
+  /**
+   * \brief Starts listening for clients and resolves the server.
+   * \param port The port the clients connect to.
+   * \param host The host name of the server.
+   * \param targetPort The port the server listens on.
+   */
+  void open(Uint16 port, const std::string& host, Uint16 targetPort);
+
+  /**
+   * \brief Runs the proxy, printing a CSV line per direction and second with
+   * the throughput, chunks, losses, reorders and mean added delay.
+   * \param duration The time to run for in milliseconds, or 0 to run forever.
+   */
+  void run(Uint32 duration);
+};
@@ -0,0 +1,83 @@
+#include "NetworkStats.h"
+
+#include <cmath>
+
+#include "Clock.h"
+#include "Constants.h"
+
+NetworkStats::NetworkStats()
+    : mutex_(SDL_CreateMutex()), windowStart_(Clock::microseconds()) {}
+
+NetworkStats::~NetworkStats() { SDL_DestroyMutex(mutex_); }
+
+void NetworkStats::addSent(const Uint64 bytes) {
+  const auto now = Clock::microseconds();
+  if (SDL_LockMutex(mutex_) == 0) {
+    snapshot_.bytesSent += bytes;
+    windowSent_ += bytes;
+    updateRates(now);
+    SDL_UnlockMutex(mutex_);
+  }
+}
+
+void NetworkStats::addReceived(const Uint64 bytes) {
+  const auto now = Clock::microseconds();
+  if (SDL_LockMutex(mutex_) == 0) {
+    snapshot_.bytesReceived += bytes;
+    windowReceived_ += bytes;
+    updateRates(now);
+    SDL_UnlockMutex(mutex_);
+  }
+}
+
+void NetworkStats::addRoundTrip(const Uint64 microseconds) {
+  const auto sample = static_cast<double>(microseconds) / 1000.0;
+  if (SDL_LockMutex(mutex_) != 0) return;
+
+  if (snapshot_.samples == 0) {
+    // The first sample seeds the estimators (RFC 6298, section 2.2)
+    snapshot_.roundTripTime = sample;
+    snapshot_.roundTripVariance = sample / 2.0;
+  } else {
+    // RTTVAR is updated before SRTT, as it uses the previous SRTT value
+    snapshot_.roundTripVariance =
+        0.75 * snapshot_.roundTripVariance +
+        0.25 * std::fabs(snapshot_.roundTripTime - sample);
+    snapshot_.roundTripTime = 0.875 * snapshot_.roundTripTime + 0.125 * sample;
+
+    // Interarrival jitter between consecutive samples (RFC 3550, A.8)
+    const auto difference = std::fabs(sample - lastRoundTrip_);
+    snapshot_.jitter += (difference - snapshot_.jitter) / 16.0;
+  }
+
+  lastRoundTrip_ = sample;
+  ++snapshot_.samples;
+  SDL_UnlockMutex(mutex_);
+}
+
+NetworkStats::snapshot_t NetworkStats::getSnapshot() const {
+  snapshot_t snapshot{};
+  if (SDL_LockMutex(mutex_) == 0) {
+    snapshot = snapshot_;
+    SDL_UnlockMutex(mutex_);
+  }
+  return snapshot;
+}
+
+double NetworkStats::getRoundTripTime() const {
+  return getSnapshot().roundTripTime;
+}
+
+double NetworkStats::getJitter() const { return getSnapshot().jitter; }
+
+void NetworkStats::updateRates(const Uint64 now) {
+  const auto elapsed = now - windowStart_;
+  if (elapsed < static_cast<Uint64>(NETWORK_STATS_WINDOW) * 1000u) return;
+
+  const auto seconds = static_cast<double>(elapsed) / 1000000.0;
+  snapshot_.sendRate = static_cast<double>(windowSent_) / seconds;
+  snapshot_.receiveRate = static_cast<double>(windowReceived_) / seconds;
+  windowSent_ = 0;
+  windowReceived_ = 0;
+  windowStart_ = now;
+}
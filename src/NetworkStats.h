@@ -0,0 +1,113 @@
+#pragma once
+#include "SDL.h"
+
+/**
+ * \brief The NetworkStats class that measures a single connection: smoothed
+ * round-trip time and jitter from ping/pong exchanges, and the amount of bytes
+ * sent and received.
+ *
+ * \note Samples are added from the network thread that owns the connection,
+ * while any other thread may read them through NetworkStats::getSnapshot().
+ */
+class NetworkStats final {
+ public:
+  typedef struct {
+    /**
+     * \brief The smoothed round-trip time, in milliseconds.
+     */
+    double roundTripTime;
+    /**
+     * \brief The smoothed mean deviation of the round-trip time, in
+     * milliseconds.
+     */
+    double roundTripVariance;
+    /**
+     * \brief The smoothed variation between consecutive round-trip times, in
+     * milliseconds.
+     */
+    double jitter;
+    /**
+     * \brief The amount of round-trip samples received.
+     */
+    Uint32 samples;
+    /**
+     * \brief The total amount of bytes sent through the connection.
+     */
+    Uint64 bytesSent;
+    /**
+     * \brief The total amount of bytes received from the connection.
+     */
+    Uint64 bytesReceived;
+    /**
+     * \brief The outgoing throughput measured in the last window, in bytes per
+     * second.
+     */
+    double sendRate;
+    /**
+     * \brief The incoming throughput measured in the last window, in bytes per
+     * second.
+     */
+    double receiveRate;
+  } snapshot_t;
+
+ private:
+  SDL_mutex* mutex_ = nullptr;
+  snapshot_t snapshot_{};
+
+  /**
+   * \brief The last raw round-trip sample, in milliseconds.
+   */
+  double lastRoundTrip_ = 0;
+
+  /**
+   * \brief The time in microseconds the current throughput window started.
+   */
+  Uint64 windowStart_ = 0;
+  Uint64 windowSent_ = 0;
+  Uint64 windowReceived_ = 0;
+
+  void updateRates(Uint64 now);
+
+ public:
+  NetworkStats();
+  ~NetworkStats();
+  NetworkStats(const NetworkStats&) = delete;             // Copy Constructor
+  NetworkStats(NetworkStats&&) = delete;                  // Move Constructor
+  NetworkStats& operator=(const NetworkStats&) = delete;  // Assignment Operator
+  NetworkStats& operator=(NetworkStats&&) = delete;       // Move Operator
+
+  /**
+   * \brief Accounts a message written into the connection.
+   * \param bytes The amount of bytes sent.
+   */
+  void addSent(Uint64 bytes);
+
+  /**
+   * \brief Accounts a message read from the connection.
+   * \param bytes The amount of bytes received.
+   */
+  void addReceived(Uint64 bytes);
+
+  /**
+   * \brief Adds a round-trip sample from a ping/pong exchange.
+   * \param microseconds The time elapsed between sending the ping and
+   * receiving its pong.
+   */
+  void addRoundTrip(Uint64 microseconds);
+
+  /**
+   * \brief Get a consistent copy of every measurement.
+   * \return The current measurements.
+   */
+  snapshot_t getSnapshot() const;
+
+  /**
+   * \return The smoothed round-trip time, in milliseconds.
+   */
+  double getRoundTripTime() const;
+
+  /**
+   * \return The smoothed jitter, in milliseconds.
+   */
+  double getJitter() const;
+};
@@ -0,0 +1,141 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include "Constants.h"
+#include "SDL.h"
+#include "SDL_atomic.h"
+
+/**
+ * \brief The ObjectPool class that hands out fixed-size blocks for one type,
+ * carved from chunks that are never returned to the heap. Released blocks go
+ * to a free list, so allocating and releasing only pop and push a pointer.
+ * \tparam T The type the blocks are sized and aligned for.
+ */
+template <class T>
+class ObjectPool final {
+  /**
+   * \brief A block, which holds a value while in use and the next free block
+   * otherwise.
+   */
+  union block_t {
+    block_t* next;
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+
+  std::vector<block_t*> chunks_{};
+  block_t* free_ = nullptr;
+  size_t capacity_ = 0;
+  size_t used_ = 0;
+
+  /**
+   * \brief Guards the free list, as game objects may be created from jobs.
+   */
+  SDL_SpinLock lock_ = 0;
+
+  void grow(const size_t count) {
+    auto* memory = ::operator new(count * sizeof(block_t));
+    auto* chunk = static_cast<block_t*>(memory);
+    chunks_.push_back(chunk);
+    for (size_t i = 0; i < count; ++i) {
+      chunk[i].next = free_;
+      free_ = &chunk[i];
+    }
+    capacity_ += count;
+  }
+
+  ObjectPool() = default;
+
+ public:
+  ~ObjectPool() {
+    for (auto* chunk : chunks_) ::operator delete(chunk);
+  }
+  ObjectPool(const ObjectPool&) = delete;             // Copy Constructor
+  ObjectPool(ObjectPool&&) = delete;                  // Move Constructor
+  ObjectPool& operator=(const ObjectPool&) = delete;  // Assignment Operator
+  ObjectPool& operator=(ObjectPool&&) = delete;       // Move Operator
+
+  /**
+   * \return The memory for one T, growing the pool by a chunk when empty.
+   */
+  void* allocate() {
+    SDL_AtomicLock(&lock_);
+    if (free_ == nullptr) grow(POOL_CHUNK_SIZE);
+    auto* block = free_;
+    free_ = block->next;
+    ++used_;
+    SDL_AtomicUnlock(&lock_);
+    return block->storage;
+  }
+
+  /**
+   * \brief Returns the memory of a destroyed T to the pool.
+   */
+  void release(void* memory) {
+    auto* block = static_cast<block_t*>(memory);
+    SDL_AtomicLock(&lock_);
+    block->next = free_;
+    free_ = block;
+    --used_;
+    SDL_AtomicUnlock(&lock_);
+  }
+
+  /**
+   * \brief Grows the pool ahead of time, so the next spawns never reach the
+   * heap.
+   * \param count The amount of free blocks to have at least.
+   */
+  void reserve(const size_t count) {
+    SDL_AtomicLock(&lock_);
+    if (capacity_ - used_ < count) grow(count - (capacity_ - used_));
+    SDL_AtomicUnlock(&lock_);
+  }
+
+  /**
+   * \return The amount of blocks in use.
+   */
+  size_t size() const { return used_; }
+
+  /**
+   * \return The amount of blocks, used or free.
+   */
+  size_t capacity() const { return capacity_; }
+
+  static ObjectPool& getInstance() {
+    static ObjectPool pool;
+    return pool;
+  }
+};
+
+/**
+ * \brief The Pooled mixin that makes a class allocate its instances from its
+ * ObjectPool, by inheriting from it with the class itself as the argument:
+ *
+ *     class Snowball : public GameObject, public Pooled<Snowball> {...};
+ *
+ * Instances are still created with new and destroyed with delete, including
+ * through a pointer to a base with a virtual destructor, such as the scene's
+ * GameObject and EventListener pointers. Subclasses of a pooled class that
+ * are larger fall back to the heap.
+ * \tparam T The class being pooled.
+ */
+template <class T>
+class Pooled {
+ public:
+  static void* operator new(const std::size_t size) {
+    if (size != sizeof(T)) return ::operator new(size);
+    return ObjectPool<T>::getInstance().allocate();
+  }
+
+  static void operator delete(void* memory, const std::size_t size) {
+    if (memory == nullptr) return;
+    if (size != sizeof(T)) return ::operator delete(memory);
+    ObjectPool<T>::getInstance().release(memory);
+  }
+
+  /**
+   * \return The pool the instances are allocated from.
+   */
+  static ObjectPool<T>& getPool() { return ObjectPool<T>::getInstance(); }
+};
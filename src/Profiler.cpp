@@ -0,0 +1,173 @@
+#include "Profiler.h"
+
+#include <cstdio>
+#include <iostream>
+
+#include "Clock.h"
+
+namespace {
+/**
+ * \brief The buffer of the calling thread, registered on its first event.
+ */
+thread_local Profiler::thread_buffer_t* currentBuffer = nullptr;
+
+/**
+ * \brief The events a buffer starts with room for, so recording does not
+ * allocate during the first frames of a capture.
+ */
+const size_t RESERVED_EVENTS = 16 * 1024;
+
+void writeString(FILE* file, const std::string& value) {
+  fputc('"', file);
+  for (const auto c : value) {
+    if (c == '"' || c == '\\') fputc('\\', file);
+    fputc(c, file);
+  }
+  fputc('"', file);
+}
+}  // namespace
+
+Profiler* Profiler::instance_ = nullptr;
+SDL_atomic_t Profiler::enabled_{};
+
+Profiler::Zone::Zone(const char* name) : name_(name), active_(isEnabled()) {
+  if (active_) start_ = Clock::nanoseconds();
+}
+
+Profiler::Zone::~Zone() {
+  // Only zones that began and ended while recording are complete
+  if (!active_ || !isEnabled()) return;
+
+  const auto end = Clock::nanoseconds();
+  getInstance()->record({name_, start_, end - start_, 0, false});
+}
+
+Profiler::Profiler() : mutex_(SDL_CreateMutex()) {}
+
+Profiler::~Profiler() {
+  SDL_AtomicSet(&enabled_, 0);
+  for (auto* buffer : buffers_) delete buffer;
+  SDL_DestroyMutex(mutex_);
+}
+
+Profiler::thread_buffer_t* Profiler::getBuffer() {
+  if (currentBuffer != nullptr) return currentBuffer;
+
+  auto* buffer = new thread_buffer_t();
+  buffer->events.reserve(RESERVED_EVENTS);
+  SDL_LockMutex(mutex_);
+  buffer->id = static_cast<int>(buffers_.size()) + 1;
+  buffer->name = "thread-" + std::to_string(buffer->id);
+  buffers_.push_back(buffer);
+  SDL_UnlockMutex(mutex_);
+
+  currentBuffer = buffer;
+  return buffer;
+}
+
+void Profiler::record(const Profiler::event_t& event) {
+  auto* buffer = getBuffer();
+  SDL_AtomicLock(&buffer->lock);
+  buffer->events.push_back(event);
+  SDL_AtomicUnlock(&buffer->lock);
+}
+
+void Profiler::start() {
+  clear();
+  SDL_AtomicSet(&enabled_, 1);
+}
+
+void Profiler::stop() { SDL_AtomicSet(&enabled_, 0); }
+
+void Profiler::toggle() {
+  if (!isEnabled()) {
+    std::cout << "Profiler: recording\n";
+    start();
+    return;
+  }
+
+  stop();
+  const auto path =
+      "snowshooter-" + std::to_string(Clock::milliseconds()) + ".json";
+  if (save(path)) std::cout << "Profiler: saved " << path << "\n";
+}
+
+void Profiler::clear() {
+  SDL_LockMutex(mutex_);
+  for (auto* buffer : buffers_) {
+    SDL_AtomicLock(&buffer->lock);
+    buffer->events.clear();
+    SDL_AtomicUnlock(&buffer->lock);
+  }
+  SDL_UnlockMutex(mutex_);
+}
+
+bool Profiler::save(const std::string& path) {
+  auto* file = fopen(path.c_str(), "w");
+  if (file == nullptr) {
+    std::cout << "Profiler: could not write " << path << "\n";
+    return false;
+  }
+
+  // Timestamps are in microseconds, with the nanoseconds as decimals
+  fputs("{\"traceEvents\":[\n", file);
+  auto first = true;
+  SDL_LockMutex(mutex_);
+  for (auto* buffer : buffers_) {
+    SDL_AtomicLock(&buffer->lock);
+    fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,",
+            first ? "" : ",\n");
+    fprintf(file, "\"tid\":%d,\"args\":{\"name\":", buffer->id);
+    writeString(file, buffer->name);
+    fputs("}}", file);
+    first = false;
+
+    for (const auto& event : buffer->events) {
+      fputs(",\n{\"name\":", file);
+      writeString(file, event.name);
+      const auto start = static_cast<double>(event.start) / 1000;
+      if (event.counter) {
+        fprintf(file,
+                ",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":%d,"
+                "\"args\":{\"value\":%g}}",
+                start, buffer->id, event.value);
+      } else {
+        fprintf(file, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,",
+                start, static_cast<double>(event.duration) / 1000);
+        fprintf(file, "\"tid\":%d}", buffer->id);
+      }
+    }
+    SDL_AtomicUnlock(&buffer->lock);
+  }
+  SDL_UnlockMutex(mutex_);
+  fputs("\n]}\n", file);
+
+  const auto written = ferror(file) == 0;
+  fclose(file);
+  if (!written) std::cout << "Profiler: could not write " << path << "\n";
+  return written;
+}
+
+void Profiler::setThreadName(const std::string& name) {
+  auto* buffer = getInstance()->getBuffer();
+  SDL_AtomicLock(&buffer->lock);
+  buffer->name = name;
+  SDL_AtomicUnlock(&buffer->lock);
+}
+
+void Profiler::counter(const char* name, const double value) {
+  if (!isEnabled()) return;
+  getInstance()->record({name, Clock::nanoseconds(), 0, value, true});
+}
+
+Profiler* Profiler::getInstance() {
+  if (instance_ == nullptr) instance_ = new Profiler();
+  return instance_;
+}
+
+void Profiler::destroy() {
+  if (instance_ != nullptr) {
+    delete instance_;
+    instance_ = nullptr;
+  }
+}
@@ -0,0 +1,158 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "SDL.h"
+#include "SDL_atomic.h"
+
+/**
+ * \brief The Profiler class that records how long the parts of a frame take,
+ * as zones, counters and thread names, and saves them as a Chrome trace that
+ * chrome://tracing and Perfetto open. Every thread records into a buffer of
+ * its own, so recording never waits on other threads.
+ *
+ * Instrumenting is done with the macros below, which only check a flag while
+ * the profiler is stopped, and are compiled out entirely unless
+ * SNOWSHOOTER_PROFILER is defined:
+ *
+ *     void Scene::render() {
+ *       PROFILE_ZONE("Scene::render");
+ *       ...
+ *     }
+ */
+class Profiler final {
+ public:
+  typedef struct {
+    const char* name;
+    Uint64 start;
+    /**
+     * \brief The zone's duration in nanoseconds, unused by counters.
+     */
+    Uint64 duration;
+    /**
+     * \brief The counter's value, unused by zones.
+     */
+    double value;
+    bool counter;
+  } event_t;
+
+  /**
+   * \brief The events recorded by one thread.
+   */
+  typedef struct {
+    std::string name;
+    int id;
+    std::vector<event_t> events;
+    /**
+     * \brief Only contended while the trace is being saved or cleared.
+     */
+    SDL_SpinLock lock;
+  } thread_buffer_t;
+
+  /**
+   * \brief The Zone class that measures the scope it lives in, from its
+   * constructor to its destructor.
+   */
+  class Zone final {
+    const char* name_;
+    Uint64 start_ = 0;
+    bool active_;
+
+   public:
+    /**
+     * \param name The zone's name, which must outlive the profiler, such as a
+     * string literal.
+     */
+    explicit Zone(const char* name);
+    ~Zone();
+    Zone(const Zone&) = delete;             // Copy Constructor
+    Zone(Zone&&) = delete;                  // Move Constructor
+    Zone& operator=(const Zone&) = delete;  // Assignment Operator
+    Zone& operator=(Zone&&) = delete;       // Move Operator
+  };
+
+ private:
+  static Profiler* instance_;
+  static SDL_atomic_t enabled_;
+
+  std::vector<thread_buffer_t*> buffers_;
+  SDL_mutex* mutex_;
+
+  Profiler();
+
+  /**
+   * \return The calling thread's buffer, created on its first event.
+   */
+  thread_buffer_t* getBuffer();
+  void record(const event_t& event);
+
+ public:
+  ~Profiler();
+  Profiler(const Profiler&) = delete;             // Copy Constructor
+  Profiler(Profiler&&) = delete;                  // Move Constructor
+  Profiler& operator=(const Profiler&) = delete;  // Assignment Operator
+  Profiler& operator=(Profiler&&) = delete;       // Move Operator
+
+  /**
+   * \return Whether or not events are being recorded.
+   */
+  static bool isEnabled() { return SDL_AtomicGet(&enabled_) != 0; }
+
+  /**
+   * \brief Discards the events recorded so far and starts recording.
+   */
+  void start();
+
+  /**
+   * \brief Stops recording, keeping the events to be saved.
+   */
+  void stop();
+
+  /**
+   * \brief Starts recording, or stops and saves the trace to a new file in
+   * the working directory if it was already.
+   */
+  void toggle();
+
+  /**
+   * \brief Discards the events recorded so far.
+   */
+  void clear();
+
+  /**
+   * \brief Saves every recorded event as Chrome trace JSON.
+   * \param path The file to write.
+   * \return Whether or not the file could be written.
+   */
+  bool save(const std::string& path);
+
+  /**
+   * \brief Names the calling thread in the trace.
+   * \param name The thread's name.
+   */
+  static void setThreadName(const std::string& name);
+
+  /**
+   * \brief Records the value of a counter, which the trace plots over time.
+   * \param name The counter's name, which must outlive the profiler.
+   * \param value The counter's current value.
+   */
+  static void counter(const char* name, double value);
+
+  static Profiler* getInstance();
+  static void destroy();
+};
+
+#ifdef SNOWSHOOTER_PROFILER
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) \
+  const Profiler::Zone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_COUNTER(name, value) \
+  Profiler::counter(name, static_cast<double>(value))
+#define PROFILE_THREAD(name) Profiler::setThreadName(name)
+#else
+#define PROFILE_ZONE(name) static_cast<void>(0)
+#define PROFILE_COUNTER(name, value) static_cast<void>(0)
+#define PROFILE_THREAD(name) static_cast<void>(0)
+#endif
@@ -0,0 +1,129 @@
+#pragma once
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "SDL_stdinc.h"
+
+/**
+ * \brief Helpers shared by the client and the server to encode the fixed-width
+ * fields of the network protocol.
+ */
+class Protocol final {
+ public:
+  Protocol() = delete;
+
+  /**
+   * \brief The character every message is terminated with, so the receiver
+   * can split the TCP stream back into messages.
+   */
+  static const char MESSAGE_END = '\n';
+
+  enum {
+    /**
+     * \brief The amount of characters a timestamp takes in a message.
+     */
+    TIMESTAMP_LENGTH = 16,
+
+    /**
+     * \brief The amount of characters a lockstep frame number takes.
+     */
+    FRAME_LENGTH = 8,
+
+    /**
+     * \brief The amount of characters a lockstep input takes: two hexadecimal
+     * digits for the buttons and four for the aim.
+     */
+    INPUT_LENGTH = 6,
+
+    /**
+     * \brief The amount of hexadecimal digits a state checksum takes.
+     */
+    CHECKSUM_LENGTH = 8,
+
+    /**
+     * \brief The length of a ping: the type and the sender's time.
+     */
+    PING_LENGTH = 1 + TIMESTAMP_LENGTH,
+
+    /**
+     * \brief The length of a pong: the type, the ping's time, and the
+     * responder's times when the ping was received and the pong was sent.
+     */
+    PONG_LENGTH = 1 + 3 * TIMESTAMP_LENGTH,
+
+    /**
+     * \brief The length of an input sent to the server: the type, the frame,
+     * and the input. The server relays it with the sender's slot appended.
+     */
+    INPUT_FRAME_LENGTH = 1 + FRAME_LENGTH + INPUT_LENGTH,
+
+    /**
+     * \brief The length of a checksum: the type, the frame, and the checksum
+     * of the state after simulating it.
+     */
+    CHECKSUM_MESSAGE_LENGTH = 1 + FRAME_LENGTH + CHECKSUM_LENGTH,
+
+    /**
+     * \brief The length of a desync notice: the type and the first frame the
+     * checksums disagreed on.
+     */
+    DESYNC_LENGTH = 1 + FRAME_LENGTH
+  };
+
+  /**
+   * \brief Writes a timestamp as a zero-padded decimal number.
+   * \param buffer The message to write into.
+   * \param input The timestamp, in microseconds.
+   * \param offset The position in the message to write at.
+   */
+  static void writeTimestamp(char* buffer, Uint64 input, size_t offset) {
+    char digits[TIMESTAMP_LENGTH + 1];
+    snprintf(digits, sizeof digits, "%016llu",
+             static_cast<unsigned long long>(input));
+    memcpy(buffer + offset, digits, TIMESTAMP_LENGTH);
+  }
+
+  /**
+   * \brief Reads a timestamp written by Protocol::writeTimestamp().
+   * \param buffer The message to read from.
+   * \param offset The position in the message to read at.
+   * \return The timestamp, in microseconds.
+   */
+  static Uint64 readTimestamp(const char* buffer, size_t offset) {
+    const std::string raw(buffer + offset, TIMESTAMP_LENGTH);
+    return static_cast<Uint64>(strtoull(raw.c_str(), nullptr, 10));
+  }
+
+  /**
+   * \brief Writes a number as zero-padded digits.
+   * \param buffer The message to write into.
+   * \param input The number, which must fit in the given width.
+   * \param offset The position in the message to write at.
+   * \param width The amount of digits to write, up to 16.
+   * \param hexadecimal Whether to write it in base 16 instead of base 10.
+   */
+  static void writeNumber(char* buffer, Uint64 input, size_t offset,
+                          size_t width, bool hexadecimal = false) {
+    char digits[17];
+    snprintf(digits, sizeof digits, hexadecimal ? "%016llX" : "%016llu",
+             static_cast<unsigned long long>(input));
+    memcpy(buffer + offset, digits + (16 - width), width);
+  }
+
+  /**
+   * \brief Reads a number written by Protocol::writeNumber().
+   * \param buffer The message to read from.
+   * \param offset The position in the message to read at.
+   * \param width The amount of digits to read.
+   * \param hexadecimal Whether it was written in base 16 instead of base 10.
+   * \return The number.
+   */
+  static Uint64 readNumber(const char* buffer, size_t offset, size_t width,
+                           bool hexadecimal = false) {
+    const std::string raw(buffer + offset, width);
+    return static_cast<Uint64>(
+        strtoull(raw.c_str(), nullptr, hexadecimal ? 16 : 10));
+  }
+};
@@ -0,0 +1,59 @@
+#include "RenderBackend.h"
+
+#include "Profiler.h"
+
+RenderBackend::RenderBackend(SDL_Renderer* renderer, const RenderMode mode)
+    : renderer_(renderer), mode_(mode) {}
+
+SDL_Texture* RenderBackend::createTexture(SDL_Surface* surface) {
+  ++stats_.textureUploads;
+  return SDL_CreateTextureFromSurface(renderer_, surface);
+}
+
+void RenderBackend::clear() {
+  if (mode_ != RenderMode::NONE) SDL_RenderClear(renderer_);
+}
+
+void RenderBackend::copy(SDL_Texture* texture, const SDL_Rect* src,
+                         const SDL_Rect* dst, const double angle,
+                         const SDL_RendererFlip flip) {
+  ++stats_.drawCalls;
+  if (mode_ == RenderMode::NONE) return;
+  SDL_RenderCopyEx(renderer_, texture, src, dst, angle, nullptr, flip);
+}
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+void RenderBackend::geometry(SDL_Texture* texture, const SDL_Vertex* vertices,
+                             const int vertexCount, const int* indices,
+                             const int indexCount) {
+  ++stats_.drawCalls;
+  if (mode_ == RenderMode::NONE) return;
+  SDL_RenderGeometry(renderer_, texture, vertices, vertexCount, indices,
+                     indexCount);
+}
+#else
+void RenderBackend::geometry(SDL_Texture*, const SDL_Vertex*, const int,
+                             const int*, const int) {}
+#endif
+
+void RenderBackend::present() {
+  PROFILE_ZONE("SDL_RenderPresent");
+  ++stats_.frames;
+  if (mode_ != RenderMode::NONE) SDL_RenderPresent(renderer_);
+}
+
+bool RenderBackend::hasVsync() const {
+  if (mode_ == RenderMode::NONE) return false;
+
+  SDL_RendererInfo info{};
+  SDL_GetRendererInfo(renderer_, &info);
+  return (info.flags & SDL_RENDERER_PRESENTVSYNC) != 0;
+}
+
+RenderMode RenderBackend::getMode() const { return mode_; }
+
+SDL_Renderer* RenderBackend::getRenderer() const { return renderer_; }
+
+const RenderBackend::stats_t& RenderBackend::getStats() const {
+  return stats_;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "SDL.h"
+
+/**
+ * \brief How the game draws its frames.
+ */
+enum class RenderMode {
+  /**
+   * \brief On the GPU, synchronized to the display.
+   */
+  ACCELERATED,
+  /**
+   * \brief On the CPU, which works without a GPU or a display.
+   */
+  SOFTWARE,
+  /**
+   * \brief Not at all, frames are only built and counted. Textures are still
+   * uploaded to a software renderer so their sizes are known.
+   */
+  NONE
+};
+
+/**
+ * \brief The RenderBackend class that every draw and texture upload goes
+ * through, counting them so frames can be measured, and dropping the draws
+ * altogether in RenderMode::NONE.
+ */
+class RenderBackend final {
+ public:
+  typedef struct {
+    Uint64 frames;
+    Uint64 drawCalls;
+    Uint64 textureUploads;
+  } stats_t;
+
+ private:
+  SDL_Renderer* renderer_;
+  RenderMode mode_;
+  stats_t stats_{};
+
+ public:
+  RenderBackend(SDL_Renderer* renderer, RenderMode mode);
+
+  /**
+   * \brief Uploads an image, to draw it with the backend.
+   * \return The texture, or nullptr if it could not be created.
+   */
+  SDL_Texture* createTexture(SDL_Surface* surface);
+
+  void clear();
+
+  /**
+   * \brief Draws part of a texture, as SDL_RenderCopyEx.
+   */
+  void copy(SDL_Texture* texture, const SDL_Rect* src, const SDL_Rect* dst,
+            double angle, SDL_RendererFlip flip);
+
+  /**
+   * \brief Draws triangles of a texture, as SDL_RenderGeometry.
+   */
+  void geometry(SDL_Texture* texture, const SDL_Vertex* vertices,
+                int vertexCount, const int* indices, int indexCount);
+
+  /**
+   * \brief Shows the frame, which ends it.
+   */
+  void present();
+
+  /**
+   * \return Whether or not presenting waits for the display, so frames do
+   * not need to be paced otherwise.
+   */
+  bool hasVsync() const;
+
+  RenderMode getMode() const;
+  SDL_Renderer* getRenderer() const;
+
+  /**
+   * \return The frames, draw calls and texture uploads counted so far.
+   */
+  const stats_t& getStats() const;
+};
@@ -0,0 +1,112 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "Constants.h"
+#include "Profiler.h"
+
+RenderQueue::RenderQueue(RenderBackend* backend) : backend_(backend) {}
+
+void RenderQueue::submit(const RenderQueue::command_t& command) {
+  if (command.texture == nullptr) return;
+
+  commands_.push_back(command);
+  commands_.back().sequence = static_cast<Uint32>(commands_.size());
+}
+
+void RenderQueue::flush() {
+  PROFILE_ZONE("RenderQueue::flush");
+  // Submission order decides the stacking within a layer, so only adjacent
+  // quads sharing a texture are batched together
+  std::sort(commands_.begin(), commands_.end(),
+            [](const command_t& a, const command_t& b) {
+              if (a.layer != b.layer) return a.layer < b.layer;
+              return a.sequence < b.sequence;
+            });
+
+  drawCalls_ = 0;
+  size_t begin = 0;
+  for (size_t i = 1; i <= commands_.size(); ++i) {
+    const auto& first = commands_[begin];
+    if (i < commands_.size() && commands_[i].texture == first.texture) continue;
+
+    draw(begin, i);
+    begin = i;
+  }
+
+  commands_.clear();
+}
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+void RenderQueue::draw(const size_t begin, const size_t end) {
+  auto* texture = commands_[begin].texture;
+  int width = 0;
+  int height = 0;
+  SDL_QueryTexture(texture, nullptr, nullptr, &width, &height);
+  if (width == 0 || height == 0) return;
+
+  // Geometry ignores the texture's modulation, so it goes into the vertices
+  SDL_Color color{255, 255, 255, 255};
+  SDL_GetTextureColorMod(texture, &color.r, &color.g, &color.b);
+  SDL_GetTextureAlphaMod(texture, &color.a);
+
+  vertices_.clear();
+  indices_.clear();
+  for (auto i = begin; i < end; ++i) {
+    const auto& command = commands_[i];
+    auto left = static_cast<float>(command.src.x) / static_cast<float>(width);
+    auto right = static_cast<float>(command.src.x + command.src.w) /
+                 static_cast<float>(width);
+    auto top = static_cast<float>(command.src.y) / static_cast<float>(height);
+    auto bottom = static_cast<float>(command.src.y + command.src.h) /
+                  static_cast<float>(height);
+    if (command.flip & SDL_FLIP_HORIZONTAL) std::swap(left, right);
+    if (command.flip & SDL_FLIP_VERTICAL) std::swap(top, bottom);
+
+    // Corners are rotated clockwise around the center, as SDL_RenderCopyEx
+    const auto halfWidth = static_cast<float>(command.dst.w) / 2;
+    const auto halfHeight = static_cast<float>(command.dst.h) / 2;
+    const auto centerX = static_cast<float>(command.dst.x) + halfWidth;
+    const auto centerY = static_cast<float>(command.dst.y) + halfHeight;
+    const auto radians = command.angle * PI / 180;
+    const auto cosine = static_cast<float>(std::cos(radians));
+    const auto sine = static_cast<float>(std::sin(radians));
+
+    const float corners[4][4] = {{-halfWidth, -halfHeight, left, top},
+                                 {halfWidth, -halfHeight, right, top},
+                                 {halfWidth, halfHeight, right, bottom},
+                                 {-halfWidth, halfHeight, left, bottom}};
+    const auto first = static_cast<int>(vertices_.size());
+    for (const auto& corner : corners) {
+      const SDL_FPoint position{
+          centerX + corner[0] * cosine - corner[1] * sine,
+          centerY + corner[0] * sine + corner[1] * cosine};
+      vertices_.push_back({position, color, {corner[2], corner[3]}});
+    }
+
+    const int quad[] = {0, 1, 2, 0, 2, 3};
+    for (const auto index : quad) indices_.push_back(first + index);
+  }
+
+  backend_->geometry(texture, vertices_.data(),
+                     static_cast<int>(vertices_.size()), indices_.data(),
+                     static_cast<int>(indices_.size()));
+  ++drawCalls_;
+}
+#else
+void RenderQueue::draw(const size_t begin, const size_t end) {
+  // Without geometry rendering, each quad of the run is copied on its own
+  for (auto i = begin; i < end; ++i) {
+    const auto& command = commands_[i];
+    backend_->copy(command.texture, &command.src, &command.dst, command.angle,
+                   command.flip);
+    ++drawCalls_;
+  }
+}
+#endif
+
+Uint32 RenderQueue::getDrawCalls() const { return drawCalls_; }
+
+size_t RenderQueue::size() const { return commands_.size(); }
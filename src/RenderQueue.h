@@ -0,0 +1,65 @@
+#pragma once
+#include <vector>
+
+#include "RenderBackend.h"
+#include "SDL.h"
+
+/**
+ * \brief The RenderQueue class that collects the textured quads drawn during a
+ * frame and draws them at once, sorted by layer. Within a layer quads keep the
+ * order they were submitted in, so objects stack as they were rendered, and
+ * every run of consecutive quads sharing a texture is drawn with a single
+ * call.
+ */
+class RenderQueue final {
+ public:
+  typedef struct {
+    SDL_Texture* texture;
+    SDL_Rect src;
+    SDL_Rect dst;
+    double angle;
+    SDL_RendererFlip flip;
+    int layer;
+    /**
+     * \brief The order it was submitted in, which decides the stacking within
+     * a layer.
+     */
+    Uint32 sequence;
+  } command_t;
+
+ private:
+  RenderBackend* backend_;
+  std::vector<command_t> commands_{};
+  std::vector<SDL_Vertex> vertices_{};
+  std::vector<int> indices_{};
+  Uint32 drawCalls_ = 0;
+
+  /**
+   * \brief Draws the commands in [begin, end), which share a texture.
+   */
+  void draw(size_t begin, size_t end);
+
+ public:
+  explicit RenderQueue(RenderBackend* backend);
+
+  /**
+   * \brief Queues a quad to be drawn on the next RenderQueue::flush().
+   * \param command The quad, whose sequence is assigned by the queue.
+   */
+  void submit(const command_t& command);
+
+  /**
+   * \brief Draws every queued quad and empties the queue.
+   */
+  void flush();
+
+  /**
+   * \return The amount of draw calls the last RenderQueue::flush() issued.
+   */
+  Uint32 getDrawCalls() const;
+
+  /**
+   * \return The amount of quads waiting to be drawn.
+   */
+  size_t size() const;
+};
@@ -1,19 +1,30 @@
 #include "Scene.h"
 
+#include <algorithm>
 #include <utility>
 
+#include "AllocationCounter.h"
+#include "Clock.h"
 #include "Constants.h"
+#include "FramePacer.h"
 #include "Game.h"
 #include "GameObject.h"
 #include "Input.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "RenderQueue.h"
 #include "SDL.h"
 #include "SDLError.h"
 #include "SceneMachine.h"
+#include "System.h"
 #include "TextureManager.h"
-#include "TimePool.h"
 
-Scene::Scene() = default;
-Scene::~Scene() = default;
+Scene::Scene() : tweens_(new TweenSystem()) { addSystem(tweens_); }
+
+Scene::~Scene() {
+  for (auto system : systems_) delete system;
+  systems_.clear();
+}
 
 bool Scene::getTransition() const { return transition_; }
 
@@ -47,50 +58,117 @@ void Scene::run() {
   resume();
 
   const auto textureManager = TextureManager::getInstance();
-  auto poolFrameRate = new TimePool(1000 / GAME_FRAMERATE, SDL_GetTicks());
+
+  // Without vsync, rendering is paced to the simulation's rate instead, and
+  // benchmarks are not paced at all
+  const auto game = Game::getInstance();
+  const auto benchmark = Game::isBenchmark();
+  const auto paced = !benchmark && !Game::getRenderBackend()->hasVsync();
+  auto pacer = FramePacer::fromRate(GAME_FRAMERATE);
+
+  // Start with a full step, so the first frame is simulated before rendering
+  const auto step = Uint64{1000000000} / GAME_FRAMERATE;
+  const auto maxAccumulated = step * GAME_MAX_STEPS;
+  auto accumulator = step;
+  auto last = Clock::nanoseconds();
+  Uint32 frames = 0;
 
   // Run the event loop
   while (!isFinished()) {
-    textureManager->tick();
+    PROFILE_ZONE("Frame");
+    const auto allocations = AllocationCounter::getCount();
+    // Benchmarks simulate exactly one step per frame, so runs are comparable
+    const auto now = benchmark ? last + step : Clock::nanoseconds();
+    accumulator += now - last;
+    last = now;
+
+    // After a long stall, drop the time that cannot be caught up with rather
+    // than freezing while simulating it
+    if (accumulator > maxAccumulated) accumulator = maxAccumulated;
+
+    // Simulate in constant steps, as many as the elapsed time covers
+    while (accumulator >= step && !isFinished()) {
+      create();
+      handleEvents();
+      update();
+      tick();
+      destroy();
+      accumulator -= step;
+    }
+
+    if (isFinished()) break;
 
-    create();
-    handleEvents();
-    update();
-    tick();
-    destroy();
+    interpolation_ =
+        static_cast<double>(accumulator) / static_cast<double>(step);
+    textureManager->tick();
     render();
+    PROFILE_COUNTER("Game objects", gameObjects_.size());
+    PROFILE_COUNTER("Draw calls", Game::getRenderQueue()->getDrawCalls());
+
+    // Swap to the next scene once its textures are resident
+    Game::getSceneMachine()->tick();
+
+    // Once the first second warmed the buffers up, frames should not allocate
+    const auto allocated = AllocationCounter::getCount() - allocations;
+    PROFILE_COUNTER("Frame allocations", allocated);
+    if (++frames > GAME_FRAMERATE && allocated != 0) game->addAllocatingFrame();
 
-    if (poolFrameRate->next(SDL_GetTicks())) {
-      SDL_Delay(poolFrameRate->getRemaining());
+    // Callbacks queued after the last step must outlive the arena's reset
+    scheduler_.persist();
+    arena_.reset();
+
+    // Once the frame limit is reached, the whole scene stack ends
+    if (game->addFrame()) {
+      Game::getSceneMachine()->popScene();
+      break;
     }
-  }
 
-  delete poolFrameRate;
+    if (paced) {
+      PROFILE_ZONE("FramePacer::wait");
+      pacer.wait();
+      PROFILE_COUNTER("Missed frames", pacer.getMissed());
+    }
+  }
 
   end();
 }
 
 void Scene::tick() {
-  if (nextTick_.empty()) return;
+  PROFILE_ZONE("Scene::tick");
+  PROFILE_COUNTER("Tasks", scheduler_.size());
 
-  for (const auto& callback : nextTick_) {
-    callback();
-  }
-  nextTick_.clear();
+  // Bursts of deferred work are spread over the next steps
+  scheduler_.run(Uint64{TASK_STEP_BUDGET} * 1000000);
 }
 
+TaskScheduler& Scene::getScheduler() { return scheduler_; }
+
+TweenSystem& Scene::getTweens() { return *tweens_; }
+
 void Scene::create() {
-  for (auto gameObject : pendingOnCreate_) {
-    // If the gameObject was removed early, skip
+  PROFILE_ZONE("Scene::create");
+  // awake() may add more game objects, which are created in the same step,
+  // so the list is walked by index and read again on every turn
+  for (created_ = 0; created_ < pendingOnCreate_.size();) {
+    // If the gameObject was removed early, its handle is stale
+    const auto gameObject = getGameObject(pendingOnCreate_[created_++]);
     if (gameObject == nullptr) continue;
     gameObjects_.push_back(gameObject);
+    byType_[std::type_index(typeid(*gameObject))].push_back(gameObject);
+    for (const auto& tag : gameObject->getTags()) {
+      byTag_[tag].push_back(gameObject);
+    }
+    grid_.insert(gameObject, gameObject->getBounds(), nextOrder_++);
+    gameObject->setMoved(false);
     if (gameObject->getActive()) gameObject->awake();
   }
 
   pendingOnCreate_.clear();
+  created_ = 0;
 }
 
 void Scene::handleEvents() {
+  PROFILE_ZONE("Scene::handleEvents");
   // Clear the Input's cache
   Input::instance()->clear();
 
@@ -100,8 +178,7 @@ void Scene::handleEvents() {
     if (event.type == SDL_QUIT) return finish(true);
 
     Input::instance()->update(event);
-    for (auto gameObject : gameObjects_)
-      if (gameObject->getActive()) gameObject->handleEvents(event);
+    events_.dispatch(event);
   }
 
   // If the escape key was pressed, pause the game
@@ -109,11 +186,20 @@ void Scene::handleEvents() {
     if (!isPaused()) {
       pause();
     } else {
-      getGameObjects().back()->destroy();
+      // Menus without the tag were created last, as the pause shows them
+      const auto menus = findByTag(PAUSE_MENU_TAG);
+      if (!menus.empty()) {
+        for (const auto menu : menus) menu->destroy();
+      } else if (!gameObjects_.empty()) {
+        gameObjects_.back()->destroy();
+      }
       resume();
     }
   }
 
+  // If the F9 key was pressed, start or stop capturing a trace
+  if (Input::isKeyDown(KeyboardKey::F9)) Profiler::getInstance()->toggle();
+
   // If the F key was pressed, toggle fullscreen
   if (Input::isKeyDown(KeyboardKey::F)) {
     SDL_Window* window_ = Game::getWindow();
@@ -128,49 +214,163 @@ void Scene::handleEvents() {
 }
 
 void Scene::update() {
-  for (auto gameObject : gameObjects_)
+  PROFILE_ZONE("Scene::update");
+  auto* jobs = JobSystem::getInstance();
+
+  // The concurrent game objects are spread over the pool first, then the rest
+  // update in order, as they may read the concurrent ones
+  ++step_;
+  concurrent_.clear();
+  serial_.clear();
+  for (auto gameObject : gameObjects_) {
+    if (!gameObject->getActive() || !isUpdateDue(gameObject)) continue;
+
+    gameObject->beginUpdate(step_);
+    if (gameObject->getConcurrent()) {
+      concurrent_.push_back(gameObject);
+    } else {
+      serial_.push_back(gameObject);
+    }
+  }
+  PROFILE_COUNTER("Game object updates", concurrent_.size() + serial_.size());
+  jobs->parallelFor(concurrent_.size(), JOB_UPDATE_BATCH,
+                    [this](const size_t begin, const size_t end) {
+                      for (auto i = begin; i < end; ++i) {
+                        concurrent_[i]->update();
+                      }
+                    });
+
+  // An earlier update may have deactivated a later game object
+  for (auto gameObject : serial_) {
     if (gameObject->getActive()) gameObject->update();
+  }
+
+  // The systems are paused along with the scene
+  if (isPaused()) return;
+  const auto step = getTimeStep();
+
+  // Consecutive concurrent systems run as one group of jobs, and every other
+  // system waits for the group before it and updates alone
+  for (auto system : systems_) {
+    if (system->isConcurrent()) {
+      systemJobs_.push_back(jobs->schedule(
+          [this, system, step]() { system->update(world_, step); }));
+      continue;
+    }
+
+    jobs->wait(systemJobs_);
+    systemJobs_.clear();
+    system->update(world_, step);
+  }
+  jobs->wait(systemJobs_);
+  systemJobs_.clear();
+}
+
+bool Scene::isUpdateDue(const GameObject* gameObject) const {
+  switch (gameObject->getUpdatePolicy()) {
+    case UpdatePolicy::ALWAYS:
+      return true;
+    case UpdatePolicy::INTERVAL: {
+      // The handle's index staggers the game objects over the interval
+      const auto phase = step_ + gameObject->getHandle().index;
+      return phase % gameObject->getUpdateInterval() == 0;
+    }
+    case UpdatePolicy::VISIBLE:
+      return gameObject->getVisibleFrame() == frame_;
+    case UpdatePolicy::EVENTS:
+      return gameObject->isUpdateRequested();
+  }
+  return true;
 }
 
 void Scene::render() {
+  PROFILE_ZONE("Scene::render");
   // Clear the screen
-  SDL_RenderClear(Game::getRenderer());
-
-  // Render each game object
-  for (auto gameObject : gameObjects_) {
-    gameObject->render();
+  const auto backend = Game::getRenderBackend();
+  backend->clear();
+
+  // Queue the entities, then the game objects, the layers decide the stacking
+  for (auto system : systems_) system->render(world_, camera_, interpolation_);
+
+  // Only the game objects in view are queued, from the bottom up
+  ++frame_;
+  query(camera_.getViewport(), visible_);
+  for (auto it = visible_.rbegin(); it != visible_.rend(); ++it) {
+    (*it)->setVisibleFrame(frame_);
+    (*it)->render();
   }
 
+  // Draw everything queued, batched by layer and texture
+  Game::getRenderQueue()->flush();
+
   // Render the new frame
-  SDL_RenderPresent(Game::getRenderer());
+  backend->present();
 }
 
 void Scene::destroy() {
-  for (auto gameObject : pendingOnDestroy_) {
-    // If the gameObject was already deleted from memory,
-    // skip this search
-    if (gameObject == nullptr) continue;
-
-    auto it = gameObjects_.begin();
-    while (it != gameObjects_.end()) {
-      if (*it == gameObject) {
-        gameObjects_.erase(it);
-        delete gameObject;
-        break;
+  PROFILE_ZONE("Scene::destroy");
+  if (!pendingOnDestroy_.empty()) {
+    // Release the handles first, repeated or stale ones are skipped. The
+    // list only lives for this step, so it is kept in the frame arena
+    ArenaVector<GameObject*> destroyed(arena_);
+    for (const auto& handle : pendingOnDestroy_) {
+      const auto gameObject = getGameObject(handle);
+      if (gameObject == nullptr) continue;
+
+      objects_.erase(handle);
+      grid_.erase(gameObject);
+      destroyed.push_back(gameObject);
+    }
+    pendingOnDestroy_.clear();
+
+    // Then drop them from the ordered lists in a single stable pass each
+    const auto isDestroyed = [this](const GameObject* gameObject) {
+      return !objects_.contains(gameObject->getHandle());
+    };
+    const auto prune = [&isDestroyed](std::vector<GameObject*>& list) {
+      list.erase(std::remove_if(list.begin(), list.end(), isDestroyed),
+                 list.end());
+    };
+    prune(gameObjects_);
+
+    // Every index the game objects were in is pruned once, however many left
+    indices_.clear();
+    for (const auto gameObject : destroyed) {
+      const auto type = byType_.find(std::type_index(typeid(*gameObject)));
+      if (type != byType_.end()) indices_.push_back(&type->second);
+      for (const auto& tag : gameObject->getTags()) {
+        const auto it = byTag_.find(tag);
+        if (it != byTag_.end()) indices_.push_back(&it->second);
       }
-      ++it;
     }
+    std::sort(indices_.begin(), indices_.end(),
+              std::less<std::vector<GameObject*>*>());
+    indices_.erase(std::unique(indices_.begin(), indices_.end()),
+                   indices_.end());
+    for (const auto index : indices_) prune(*index);
+
+    for (auto gameObject : destroyed) delete gameObject;
   }
 
-  pendingOnDestroy_.clear();
+  // Destroy the entities the systems queued while iterating
+  world_.flush();
 }
 
 void Scene::end() {
-  // Delete the Scene's cache.
-  for (auto gameObject : gameObjects_) {
-    delete gameObject;
-  }
+  // Delete the Scene's cache, including the objects pending to be created.
+  // The tweens go first, so deleting the objects does not look them up
+  tweens_->clear();
+  objects_.each([](GameObject* gameObject) { delete gameObject; });
+  objects_.clear();
   gameObjects_.clear();
+  byType_.clear();
+  byTag_.clear();
+  pendingOnCreate_.clear();
+  created_ = 0;
+  pendingOnDestroy_.clear();
+  grid_.clear();
+  moved_.clear();
+  world_.clear();
 
   onEndHandler_();
 }
@@ -192,16 +392,99 @@ void Scene::finish(bool force) {
   paused_ = true;
 }
 
-std::list<GameObject*> Scene::getGameObjects() const { return gameObjects_; }
+void Scene::requireTexture(const std::string& name, const std::string& path,
+                           const Uint16 columns, const Uint16 rows) {
+  assets_.push_back({name, path, columns, rows});
+}
+
+const std::vector<TextureManager::request_t>& Scene::getAssets() const {
+  return assets_;
+}
+
+Span<GameObject* const> Scene::getGameObjects() const {
+  return gameObjects_;
+}
 
 void Scene::addGameObject(GameObject* gameObject) {
-  pendingOnCreate_.push_back(gameObject);
+  const auto handle = objects_.insert(gameObject);
+  gameObject->setHandle(handle);
+  pendingOnCreate_.push_back(handle);
 }
 
 void Scene::removeGameObject(GameObject* gameObject) {
-  pendingOnDestroy_.push_back(gameObject);
+  pendingOnDestroy_.push_back(gameObject->getHandle());
+}
+
+Span<GameObject* const> Scene::findByTag(const std::string& tag) const {
+  const auto it = byTag_.find(tag);
+  if (it == byTag_.end()) return {};
+  return it->second;
+}
+
+GameObject* Scene::getGameObject(const GameObject::handle_t& handle) const {
+  const auto gameObject = objects_.get(handle);
+  return gameObject == nullptr ? nullptr : *gameObject;
+}
+
+void Scene::indexTag(GameObject* gameObject, const std::string& tag) {
+  // Game objects waiting to be created are indexed along with all their tags
+  const auto handle = gameObject->getHandle();
+  if (!objects_.contains(handle)) return;
+  for (auto i = created_; i < pendingOnCreate_.size(); ++i) {
+    const auto& pending = pendingOnCreate_[i];
+    if (pending.index == handle.index &&
+        pending.generation == handle.generation) {
+      return;
+    }
+  }
+
+  byTag_[tag].push_back(gameObject);
+}
+
+void Scene::moveGameObject(const GameObject::handle_t& handle) {
+  SDL_AtomicLock(&movedLock_);
+  moved_.push_back(handle);
+  SDL_AtomicUnlock(&movedLock_);
+}
+
+void Scene::refreshBounds() {
+  for (const auto& handle : moved_) {
+    // Destroyed game objects are skipped, and the ones pending to be created
+    // are indexed by Scene::create
+    const auto gameObject = getGameObject(handle);
+    if (gameObject == nullptr) continue;
+
+    grid_.update(gameObject, gameObject->getBounds());
+    gameObject->setMoved(false);
+  }
+  moved_.clear();
 }
 
-void Scene::processNextTick(std::function<void()> callback) {
-  nextTick_.push_back(callback);
+GameObject* Scene::pick(const SDL_Point& point) {
+  refreshBounds();
+  grid_.query(point, picked_);
+  for (auto gameObject : picked_) {
+    const auto scanned = gameObject->clickScan(point);
+    if (scanned) return scanned;
+  }
+  return nullptr;
 }
+
+void Scene::query(const SDL_Rect& rect, std::vector<GameObject*>& result) {
+  refreshBounds();
+  grid_.query(rect, result);
+}
+
+FrameArena& Scene::getArena() { return arena_; }
+
+World& Scene::getWorld() { return world_; }
+
+Camera& Scene::getCamera() { return camera_; }
+
+EventRouter& Scene::getEventRouter() { return events_; }
+
+void Scene::addSystem(System* system) { systems_.push_back(system); }
+
+double Scene::getInterpolation() const { return interpolation_; }
+
+double Scene::getTimeStep() { return 1.0 / GAME_FRAMERATE; }
@@ -1,8 +1,28 @@
 #pragma once
 #include <functional>
-#include <list>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
-class GameObject;
+#include "Camera.h"
+#include "Constants.h"
+#include "EventRouter.h"
+#include "FrameArena.h"
+#include "GameObject.h"
+#include "JobSystem.h"
+#include "SDL_atomic.h"
+#include "SlotMap.h"
+#include "Span.h"
+#include "SpatialGrid.h"
+#include "TaskScheduler.h"
+#include "TextureManager.h"
+#include "TweenSystem.h"
+#include "World.h"
+
+class System;
 
 class Scene {
   bool loaded_ = false;
@@ -12,11 +32,128 @@ class Scene {
   bool game_ = false;
   std::function<void()> onEndHandler_;
 
+  /**
+   * \brief How far the rendered frame is between the last simulation step and
+   * the next one, from 0 to 1.
+   */
+  double interpolation_ = 0;
+
  protected:
-  std::list<GameObject*> gameObjects_;
-  std::list<GameObject*> pendingOnCreate_;
-  std::list<GameObject*> pendingOnDestroy_;
-  std::list<std::function<void()>> nextTick_;
+  /**
+   * \brief Every game object added to the scene, including the ones pending
+   * to be created, by handle.
+   */
+  SlotMap<GameObject*> objects_;
+
+  /**
+   * \brief The created game objects, in the order they are updated and
+   * rendered.
+   */
+  std::vector<GameObject*> gameObjects_;
+  std::vector<GameObject::handle_t> pendingOnCreate_;
+
+  /**
+   * \brief How many of the pending game objects `create()` went through, so
+   * the ones `awake()` adds can be told apart.
+   */
+  size_t created_ = 0;
+  std::vector<GameObject::handle_t> pendingOnDestroy_;
+
+  /**
+   * \brief The created game objects by their class and by tag, each in the
+   * order they were created.
+   */
+  std::unordered_map<std::type_index, std::vector<GameObject*>> byType_;
+  std::unordered_map<std::string, std::vector<GameObject*>> byTag_;
+  std::vector<std::vector<GameObject*>*> indices_;
+
+  /**
+   * \brief The active concurrent game objects of the current update, kept to
+   * reuse its memory.
+   */
+  std::vector<GameObject*> concurrent_;
+  std::vector<GameObject*> serial_;
+  std::vector<JobSystem::job_t> systemJobs_;
+
+  /**
+   * \brief The simulation steps run and the frames rendered so far.
+   */
+  Uint64 step_ = 0;
+  Uint64 frame_ = 0;
+
+  /**
+   * \return Whether or not a game object's update policy lets it update on
+   * the current step.
+   */
+  bool isUpdateDue(const GameObject* gameObject) const;
+
+  /**
+   * \brief The bounds of every created game object's tree, stacked in the
+   * order they are rendered, for picking and visibility queries.
+   */
+  SpatialGrid<GameObject*> grid_{SPATIAL_CELL_SIZE};
+  Uint64 nextOrder_ = 0;
+  std::vector<GameObject*> picked_;
+
+  Camera camera_;
+
+  /**
+   * \brief The listeners of the scene's game objects, by event type.
+   */
+  EventRouter events_{camera_};
+
+  /**
+   * \brief The game objects in view of the frame being rendered.
+   */
+  std::vector<GameObject*> visible_;
+
+  /**
+   * \brief The game objects whose bounds changed since the last query, which
+   * concurrent updates may add to at the same time.
+   */
+  std::vector<GameObject::handle_t> moved_;
+  SDL_SpinLock movedLock_ = 0;
+
+  /**
+   * \brief Reindexes the game objects that moved.
+   */
+  void refreshBounds();
+
+  /**
+   * \brief The memory for data that only lives for a frame, released at the
+   * end of every frame.
+   */
+  FrameArena arena_;
+
+  /**
+   * \brief The deferred work, which runs after every simulation step within
+   * a time budget. Tasks for the next step are stored in the frame arena.
+   */
+  TaskScheduler scheduler_{arena_};
+
+  /**
+   * \brief The entities simulated by the systems, such as snowballs and
+   * particles, while GameObject instances are left for the UI.
+   */
+  World world_;
+  std::vector<System*> systems_;
+
+  /**
+   * \brief The scene's tweens and timers, the first of its systems.
+   */
+  TweenSystem* tweens_;
+
+  /**
+   * \brief The textures the scene needs, which are resident before it runs.
+   */
+  std::vector<TextureManager::request_t> assets_;
+
+  /**
+   * \brief Declares a texture the scene needs, from its constructor, so the
+   * SceneMachine can preload it while the previous scene keeps running.
+   */
+  void requireTexture(const std::string& name, const std::string& path,
+                      Uint16 columns, Uint16 rows);
 
  public:
   Scene();
@@ -41,14 +178,156 @@ class Scene {
   virtual void destroy();
   virtual void end();
 
+  /**
+   * \brief Pauses the game objects. Overrides that show a menu must tag it
+   * with PAUSE_MENU_TAG, so Escape closes it along with the pause.
+   */
   virtual void pause();
   virtual void resume();
 
   void finish(bool force = true);
 
-  std::list<GameObject*> getGameObjects() const;
+  /**
+   * \brief Get the textures the scene declared it needs.
+   * \return The textures, as requests to the TextureManager.
+   */
+  const std::vector<TextureManager::request_t>& getAssets() const;
+
+  /**
+   * \brief Get the created game objects, in the order they are updated and
+   * rendered, without copying them.
+   * \return A view that is invalidated when game objects are created or
+   * destroyed.
+   */
+  Span<GameObject* const> getGameObjects() const;
   void addGameObject(GameObject* gameObject);
   void removeGameObject(GameObject* gameObject);
 
-  void processNextTick(std::function<void()> callback);
+  /**
+   * \brief Finds the created game objects of a class, without scanning them.
+   * \tparam T The class, subclasses of it are not included.
+   * \return A view, in creation order, that is invalidated when game objects
+   * are created or destroyed.
+   */
+  template <class T>
+  Span<GameObject* const> findByType() const {
+    const auto it = byType_.find(std::type_index(typeid(T)));
+    if (it == byType_.end()) return {};
+    return it->second;
+  }
+
+  /**
+   * \brief Finds the created game objects with a tag, without scanning them.
+   * \return A view, in creation order, that is invalidated when game objects
+   * are created or destroyed.
+   */
+  Span<GameObject* const> findByTag(const std::string& tag) const;
+
+  /**
+   * \brief Get a game object by handle.
+   * \return The game object, or nullptr if it was destroyed.
+   */
+  GameObject* getGameObject(const GameObject::handle_t& handle) const;
+
+  /**
+   * \brief Queues a game object whose tree changed its bounds to be
+   * reindexed, which is safe to call from concurrent updates.
+   */
+  void moveGameObject(const GameObject::handle_t& handle);
+
+  /**
+   * \brief Indexes a tag added to a game object after its creation, appending
+   * it to the ones Scene::findByTag() returns. Must not be called from
+   * concurrent updates.
+   */
+  void indexTag(GameObject* gameObject, const std::string& tag);
+
+  /**
+   * \brief Finds the topmost game object under a point, as
+   * GameObject::clickScan() resolves it.
+   * \return The game object, or nullptr if there is none.
+   */
+  GameObject* pick(const SDL_Point& point);
+
+  /**
+   * \brief Finds the game objects whose tree intersects an area.
+   * \param rect The area to look in.
+   * \param result Filled with the game objects found, from the top down.
+   */
+  void query(const SDL_Rect& rect, std::vector<GameObject*>& result);
+
+  /**
+   * \brief Runs a callback after the next simulation step, or a later one
+   * when the step's task budget is already spent. The callback is stored in
+   * the frame arena instead of on the heap, unless it rolls over.
+   * \param callback A function taking no arguments.
+   * \param priority High priority callbacks always run on the next step.
+   */
+  template <class F>
+  void processNextTick(F callback,
+                       TaskPriority priority = TaskPriority::NORMAL) {
+    scheduler_.schedule(std::move(callback), priority);
+  }
+
+  /**
+   * \brief Get the scene's deferred work, to delay tasks or split them over
+   * several steps.
+   * \return The task scheduler.
+   */
+  TaskScheduler& getScheduler();
+
+  /**
+   * \brief Get the animations of the scene's values and game objects, which
+   * advance every simulation step.
+   * \return The tween system.
+   */
+  TweenSystem& getTweens();
+
+  /**
+   * \brief Get the memory for transient data of the current frame, which is
+   * released once the frame ends.
+   * \return The scene's frame arena, only usable from the main thread.
+   */
+  FrameArena& getArena();
+
+  /**
+   * \brief Get the scene's entities.
+   * \return The entity-component storage.
+   */
+  World& getWorld();
+
+  /**
+   * \brief Get the scene's view, which only the game objects and entities
+   * inside of are rendered.
+   * \return The camera.
+   */
+  Camera& getCamera();
+
+  /**
+   * \brief Get the table the scene's events are dispatched through, which
+   * every EventListener subscribes to.
+   * \return The event router.
+   */
+  EventRouter& getEventRouter();
+
+  /**
+   * \brief Adds a system, which is updated every simulation step and rendered
+   * every frame in the order they were added. The scene takes its ownership.
+   * \param system The system to add.
+   */
+  void addSystem(System* system);
+
+  /**
+   * \brief Get how far the frame being rendered is between the last
+   * simulation step and the next one, to draw moving objects in between.
+   * \return A value from 0, the last step's state, to 1, the next step's.
+   */
+  double getInterpolation() const;
+
+  /**
+   * \brief Get the time every simulation step advances, which is constant no
+   * matter how fast the scene is rendered.
+   * \return The step's duration in seconds.
+   */
+  static double getTimeStep();
 };
\ No newline at end of file
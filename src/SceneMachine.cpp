@@ -1,19 +1,37 @@
 #include "SceneMachine.h"
 
 #include "Scene.h"
+#include "TextureManager.h"
 
 SceneMachine::SceneMachine() = default;
 
 SceneMachine::~SceneMachine() {
+  delete next_;
   while (!sceneStack_.empty()) {
     delete sceneStack_.top();
     sceneStack_.pop();
   }
 }
 
-void SceneMachine::pushScene(Scene* scene) { sceneStack_.push(scene); }
+void SceneMachine::pushScene(Scene* scene) {
+  TextureManager::getInstance()->load(scene->getAssets());
+  sceneStack_.push(scene);
+}
 
 void SceneMachine::changeScene(Scene* scene) {
+  if (next_ != scene) delete next_;
+  next_ = nullptr;
+
+  // With nothing running in the meantime, there is no reason to wait
+  if (scene == nullptr || sceneStack_.empty()) return swap(scene);
+
+  auto textures = TextureManager::getInstance();
+  for (const auto& asset : scene->getAssets()) textures->preload(asset);
+  next_ = scene;
+  tick();
+}
+
+void SceneMachine::swap(Scene* scene) {
   if (!sceneStack_.empty()) {
     const auto previous = sceneStack_.top();
     previous->setOnEndHandler([this, scene, previous]() {
@@ -31,8 +49,30 @@ void SceneMachine::changeScene(Scene* scene) {
 
 void SceneMachine::popScene() { changeScene(nullptr); }
 
+void SceneMachine::tick() {
+  if (next_ == nullptr || getLoadingProgress() < 1) return;
+
+  const auto scene = next_;
+  next_ = nullptr;
+  swap(scene);
+}
+
+bool SceneMachine::isLoading() const { return next_ != nullptr; }
+
+double SceneMachine::getLoadingProgress() const {
+  if (next_ == nullptr || next_->getAssets().empty()) return 1;
+
+  const auto textures = TextureManager::getInstance();
+  const auto& assets = next_->getAssets();
+  size_t resident = 0;
+  for (const auto& asset : assets) {
+    if (textures->isResident(asset.name)) ++resident;
+  }
+  return static_cast<double>(resident) / static_cast<double>(assets.size());
+}
+
 bool SceneMachine::isEmpty() const { return sceneStack_.empty(); }
 
 Scene* SceneMachine::getCurrentScene() {
   return sceneStack_.empty() ? nullptr : sceneStack_.top();
-}
\ No newline at end of file
+}
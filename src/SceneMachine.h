@@ -10,6 +10,18 @@ class SceneMachine final {
  protected:
   std::stack<Scene*> sceneStack_;
 
+  /**
+   * \brief The scene changed to, whose textures are still being preloaded
+   * while the current scene keeps running.
+   */
+  Scene* next_ = nullptr;
+
+  /**
+   * \brief Finishes the current scene, replacing it with another one once it
+   * ended.
+   */
+  void swap(Scene* scene);
+
  public:
   SceneMachine();
   ~SceneMachine();
@@ -19,9 +31,40 @@ class SceneMachine final {
       default;                                        // Assignment Operator
   SceneMachine& operator=(SceneMachine&&) = default;  // Move Operator
 
+  /**
+   * \brief Pushes a scene, loading its textures first.
+   */
   void pushScene(Scene* scene);
+
+  /**
+   * \brief Replaces the current scene, preloading the new scene's textures
+   * in the background first. The current scene keeps running until they are
+   * resident, and a change requested meanwhile replaces this one.
+   */
   void changeScene(Scene* scene);
+
+  /**
+   * \brief Ends the current scene, cancelling any pending change.
+   */
   void popScene();
+
+  /**
+   * \brief Swaps to the pending scene if its textures are resident, called
+   * once per frame.
+   */
+  void tick();
+
+  /**
+   * \return Whether or not a scene change is waiting on its textures.
+   */
+  bool isLoading() const;
+
+  /**
+   * \brief Get how much of the pending scene is loaded, for loading screens.
+   * \return A value from 0 to 1, which is 1 when nothing is pending.
+   */
+  double getLoadingProgress() const;
+
   bool isEmpty() const;
   Scene* getCurrentScene();
-};
\ No newline at end of file
+};
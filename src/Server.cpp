@@ -1,9 +1,14 @@
 #include "Server.h"
 
-#include <ctime>
+#include <algorithm>
 #include <string>
 
 #include "Client.h"
+#include "Clock.h"
+#include "Constants.h"
+#include "FramePacer.h"
+#include "Profiler.h"
+#include "Protocol.h"
 
 bool Server::ServerGame::addPlayer(const Server::user_t& user) {
   if (status_ != Status::OPEN) return false;
@@ -64,7 +69,7 @@ bool Server::ServerGame::removePlayer(const Server::user_t& user) {
 bool Server::ServerGame::shoot(const Server::user_t& user) {
   for (auto& player : players_) {
     if (player.id == user.id) {
-      const auto now = std::time(nullptr);
+      const auto now = Clock::milliseconds();
       if (player.availableShoot > now) return false;
 
       player.availableShoot = now + 750;
@@ -74,15 +79,16 @@ bool Server::ServerGame::shoot(const Server::user_t& user) {
 
       const auto server = Server::getInstance();
 
-      // Broadcast message
-      char bulletShotMessage[18];
+      // Broadcast message, tagged with the server time
+      char bulletShotMessage[34];
       write8(bulletShotMessage, getCharacterFrom(SHOT_CREATE), 0);
-      write32(bulletShotMessage, bullet.id, 1);
-      write32(bulletShotMessage, bullet.x, 5);
-      write32(bulletShotMessage, bullet.y, 9);
-      write32(bulletShotMessage, bullet.direction, 13);
-      write8(bulletShotMessage, player.id, 17);
-      server->broadcast(bulletShotMessage, 18);
+      Protocol::writeTimestamp(bulletShotMessage, Clock::microseconds(), 1);
+      write32(bulletShotMessage, bullet.id, 17);
+      write32(bulletShotMessage, bullet.x, 21);
+      write32(bulletShotMessage, bullet.y, 25);
+      write32(bulletShotMessage, bullet.direction, 29);
+      write8(bulletShotMessage, player.id, 33);
+      server->broadcast(bulletShotMessage, 34);
 
       return true;
     }
@@ -111,9 +117,12 @@ bool Server::ServerGame::ready() {
 
   const auto server = Server::getInstance();
 
+  // Lockstep players get their own slot, and simulate the game themselves
+  if (Server::isLockstep()) return server->startLockstep();
+
   // Broadcast message
-  char readyMessage[]{getCharacterFrom(GAME_READY)};
-  server->broadcast(readyMessage, 1);
+  char readyMessage[]{getCharacterFrom(GAME_READY), 's'};
+  server->broadcast(readyMessage, 2);
 
   return true;
 }
@@ -138,7 +147,10 @@ bool Server::ServerGame::end() {
 }
 
 void Server::ServerGame::check() {
-  const auto now = std::time(nullptr);
+  // The lockstep players simulate everything, the server only relays inputs
+  if (Server::isLockstep()) return;
+
+  const auto now = Clock::milliseconds();
   const auto server = Server::getInstance();
 
   size_t i = 0;
@@ -146,7 +158,7 @@ void Server::ServerGame::check() {
   // Clean-up expired bullets
   while (i < bullets_.size()) {
     const auto bullet = bullets_[i];
-    if (bullet.expires >= now) {
+    if (now >= bullet.expires) {
       bullets_.erase(bullets_.begin() + static_cast<long>(i));
 
       // Broadcast message
@@ -159,16 +171,17 @@ void Server::ServerGame::check() {
     }
   }
 
-  // Resurrect players
-  const auto size = players_.size() * 17 + 1;
+  // Resurrect players, the snapshot is tagged with the server time
+  const auto size = players_.size() * 17 + 1 + Protocol::TIMESTAMP_LENGTH;
   auto* syncMessage = static_cast<char*>(malloc(size + 1));
   write8(syncMessage, getCharacterFrom(PLAYERS_SYNC), 0);
-  size_t offset = 1;
+  Protocol::writeTimestamp(syncMessage, Clock::microseconds(), 1);
+  size_t offset = 1 + Protocol::TIMESTAMP_LENGTH;
 
   i = 0;
   while (i < players_.size()) {
     auto& player = players_[i];
-    if (!player.alive && player.availableRevive >= now) {
+    if (!player.alive && now >= player.availableRevive) {
       player.alive = true;
 
       // Broadcast message
@@ -179,14 +192,16 @@ void Server::ServerGame::check() {
     }
 
     write8(syncMessage, player.id, offset);
-    write32(syncMessage, player.x, offset + 4);
-    write32(syncMessage, player.y, offset + 8);
-    write32(syncMessage, player.direction, offset + 12);
-    write32(syncMessage, player.speed, offset + 16);
+    write32(syncMessage, player.x, offset + 1);
+    write32(syncMessage, player.y, offset + 5);
+    write32(syncMessage, player.direction, offset + 9);
+    write32(syncMessage, player.speed, offset + 13);
     offset += 17;
+    ++i;
   }
 
   server->broadcast(syncMessage, static_cast<int>(size));
+  free(syncMessage);
 }
 
 char Server::ServerGame::getCharacterFrom(int type) {
@@ -211,34 +226,140 @@ void Server::ServerClient::initialize() {
   status_ = ClientStatus::RUNNING;
   Server::pushEvent({ServerEventDataType::CONNECT, this, &ipAddress});
 
+  // Wait on a socket set, so the queue and pings are handled while idle
+  socketSet_ = SDLNet_AllocSocketSet(1);
+  SDLNet_TCP_AddSocket(socketSet_, socket_);
+
+  auto nextPing = Clock::milliseconds();
   while (Server::getRunning()) {
     // Handle game events on queue
     client_event_data_t ed;
     while (clientPollEvent(&ed) != 0) {
-      SDLNet_TCP_Send(socket_, ed.data, ed.length);
+      send(ed.data, ed.length);
+      free(ed.data);
     }
 
+    const auto now = Clock::milliseconds();
+    if (now >= nextPing) {
+      sendPing();
+      nextPing = now + NETWORK_PING_INTERVAL;
+    }
+
+    if (SDLNet_CheckSockets(socketSet_, NETWORK_POLL_INTERVAL) <= 0 ||
+        !SDLNet_SocketReady(socket_))
+      continue;
+
     // Read the buffer from the client
-    char message[1024];
-    int len = SDLNet_TCP_Recv(socket_, message, 1024);
-    if (!len) {
+    char buffer[1024];
+    int len = SDLNet_TCP_Recv(socket_, buffer, sizeof buffer);
+    if (len <= 0) {
       printf("SDLNet_TCP_Recv: %s\n", SDLNet_GetError());
       break;
     }
 
-    // Print the received message
-    printf("Received: %.*s\n", len, message);
-    if (message[0] == 'q') {
-      printf("Disconnecting on a q\n");
-      Server::pushEvent({ServerEventDataType::DISCONNECT, this, nullptr});
-      break;
+    stats_.addReceived(static_cast<Uint64>(len));
+
+    // Split the stream into messages, keeping any incomplete one for later
+    incoming_.append(buffer, static_cast<size_t>(len));
+    bool disconnect = false;
+    size_t start = 0;
+    size_t end;
+    while (!disconnect && (end = incoming_.find(Protocol::MESSAGE_END,
+                                                start)) != std::string::npos) {
+      incoming_[end] = '\0';
+      disconnect =
+          handleMessage(&incoming_[start], static_cast<int>(end - start));
+      start = end + 1;
     }
+    incoming_.erase(0, start);
+    if (disconnect) break;
   }
 
-  status_ = ClientStatus::CLOSED;
+  SDLNet_FreeSocketSet(socketSet_);
+  socketSet_ = nullptr;
   SDLNet_TCP_Close(socket_);
+
+  // Marked last, as the server may free this instance once it is closed
+  status_ = ClientStatus::CLOSED;
 }
 
+bool Server::ServerClient::handleMessage(char* message, const int length) {
+  if (length <= 0) return false;
+  if (handleControl(message, length)) return false;
+
+  // Lockstep messages involve the other clients, so the main thread handles
+  // them with its own copy
+  const auto type = static_cast<int>(message[0] - 'a');
+  if (type == INPUT_FRAME || type == CHECKSUM) {
+    auto* data = static_cast<char*>(malloc(static_cast<size_t>(length) + 1));
+    memcpy(data, message, static_cast<size_t>(length) + 1);
+    Server::pushEvent({ServerEventDataType::MESSAGE, this, data});
+    return false;
+  }
+
+  // Print the received message
+  printf("Received: %.*s\n", length, message);
+  if (message[0] == 'q') {
+    printf("Disconnecting on a q\n");
+    Server::pushEvent({ServerEventDataType::DISCONNECT, this, nullptr});
+    return true;
+  }
+
+  return false;
+}
+
+int Server::ServerClient::send(const char* message, const int length) {
+  // Written at once, so the terminator never travels in a separate packet
+  outgoing_.assign(message, static_cast<size_t>(length));
+  outgoing_ += Protocol::MESSAGE_END;
+  const auto sent = SDLNet_TCP_Send(socket_, outgoing_.data(),
+                                    static_cast<int>(outgoing_.size()));
+  if (sent > 0) stats_.addSent(static_cast<Uint64>(sent));
+  return sent;
+}
+
+void Server::ServerClient::sendPing() {
+  char ping[Protocol::PING_LENGTH];
+  ping[0] = static_cast<char>(PING + 'a');
+  Protocol::writeTimestamp(ping, Clock::microseconds(), 1);
+  send(ping, sizeof ping);
+}
+
+bool Server::ServerClient::handleControl(const char* message,
+                                         const int length) {
+  const auto now = Clock::microseconds();
+  const auto type = static_cast<int>(message[0] - 'a');
+  if (type == PING && length >= Protocol::PING_LENGTH) {
+    char pong[Protocol::PONG_LENGTH];
+    pong[0] = static_cast<char>(PONG + 'a');
+    memcpy(pong + 1, message + 1, Protocol::TIMESTAMP_LENGTH);
+    Protocol::writeTimestamp(pong, now, 1 + Protocol::TIMESTAMP_LENGTH);
+    Protocol::writeTimestamp(pong, Clock::microseconds(),
+                             1 + 2 * Protocol::TIMESTAMP_LENGTH);
+    send(pong, sizeof pong);
+    return true;
+  }
+
+  if (type == PONG && length >= Protocol::PONG_LENGTH) {
+    const auto sent = Protocol::readTimestamp(message, 1);
+    const auto received =
+        Protocol::readTimestamp(message, 1 + Protocol::TIMESTAMP_LENGTH);
+    const auto replied =
+        Protocol::readTimestamp(message, 1 + 2 * Protocol::TIMESTAMP_LENGTH);
+    if (now < sent || replied < received) return true;
+
+    // Exclude the time the peer took to reply from the round trip
+    const auto elapsed = now - sent;
+    const auto processing = replied - received;
+    if (elapsed >= processing) stats_.addRoundTrip(elapsed - processing);
+    return true;
+  }
+
+  return false;
+}
+
+const NetworkStats& Server::ServerClient::getStats() const { return stats_; }
+
 Server::ServerClient::ServerClient(TCPsocket socket) : socket_(socket) {}
 
 bool Server::ServerClient::isPending() {
@@ -265,7 +386,7 @@ SDL_mutex* Server::ServerClient::getMutex() {
 }
 
 void Server::ServerClient::pushEvent(const Server::client_event_data_t& event) {
-  if (SDL_LockMutex(getMutex())) {
+  if (SDL_LockMutex(getMutex()) == 0) {
     events_.push(event);
     SDL_UnlockMutex(event_mutex_);
   } else {
@@ -274,8 +395,11 @@ void Server::ServerClient::pushEvent(const Server::client_event_data_t& event) {
 }
 
 int Server::ServerClient::clientPollEvent(Server::client_event_data_t* event) {
-  if (SDL_LockMutex(getMutex())) {
-    if (events_.empty()) return 0;
+  if (SDL_LockMutex(getMutex()) == 0) {
+    if (events_.empty()) {
+      SDL_UnlockMutex(event_mutex_);
+      return 0;
+    }
     *event = events_.front();
     events_.pop();
 
@@ -288,6 +412,8 @@ int Server::ServerClient::clientPollEvent(Server::client_event_data_t* event) {
 }
 
 Server* Server::instance_ = nullptr;
+Uint16 Server::port_ = SERVER_PORT;
+bool Server::lockstep_ = false;
 SDL_atomic_t Server::running_{};
 SDL_mutex* Server::event_mutex_ = nullptr;
 std::queue<Server::server_event_data_t> Server::events_{};
@@ -304,7 +430,7 @@ Server::Server() {
   }
 
   printf("Starting server...\n");
-  if (SDLNet_ResolveHost(&ip_, nullptr, 9999) == -1) {
+  if (SDLNet_ResolveHost(&ip_, nullptr, port_) == -1) {
     printf("SDLNet_ResolveHost: %s\n", SDLNet_GetError());
     exit(1);
   }
@@ -325,6 +451,7 @@ Server::~Server() {
 }
 
 void Server::run() {
+  auto pacer = FramePacer::fromRate(SERVER_TICKRATE);
   while (!done_) {
     // Handle SDL events on queue
     SDL_Event e;
@@ -343,29 +470,53 @@ void Server::run() {
           printf("Client Disconnected.");
           break;
         case ServerEventDataType::CONNECT:
-          printf("Client Connected %d!", *reinterpret_cast<uint32_t*>(ed.data));
+          printf("Client Connected!");
+
+          // Other threads read the clients through Server::getStats()
+          SDL_LockMutex(getMutex());
+          clients_.push_back(ed.sender);
+          SDL_UnlockMutex(event_mutex_);
+          break;
+        case ServerEventDataType::MESSAGE: {
+          auto* message = static_cast<char*>(ed.data);
+          handleLockstep(ed.sender, message,
+                         static_cast<int>(strlen(message)));
+          free(message);
           break;
+        }
       }
     }
 
     // Free memory
+    SDL_LockMutex(getMutex());
     size_t i = 0;
     while (i < clients_.size()) {
       auto* client = clients_[i];
       if (client->isClosed()) {
+        // The lockstep match cannot advance without every player's inputs
+        const auto peer = std::find(peers_.begin(), peers_.end(), client);
+        if (peer != peers_.end()) {
+          peers_.erase(peer);
+          char endMessage[]{static_cast<char>(GAME_END + 'a')};
+          broadcastPeers(endMessage, 1);
+          peers_.clear();
+        }
+
         clients_.erase(clients_.begin() + static_cast<long>(i));
         delete client;
       } else {
         ++i;
       }
     }
+    SDL_UnlockMutex(event_mutex_);
 
     // Try to accept a connection
     auto* client = SDLNet_TCP_Accept(server_);
 
     // No connection accepted
     if (!client) {
-      SDL_Delay(1000 / 30);
+      pacer.wait();
+      PROFILE_COUNTER("Missed ticks", pacer.getMissed());
       continue;
     }
 
@@ -387,6 +538,81 @@ Server* Server::getInstance() {
   return instance_;
 }
 
+void Server::setPort(const Uint16 port) { port_ = port; }
+
+void Server::setLockstep(const bool lockstep) { lockstep_ = lockstep; }
+
+bool Server::isLockstep() { return lockstep_; }
+
+bool Server::startLockstep() {
+  peers_.clear();
+  checksums_.clear();
+  desynced_ = false;
+  for (const auto client : clients_) {
+    if (client->isRunning() && peers_.size() < LOCKSTEP_MAX_PEERS) {
+      peers_.push_back(client);
+    }
+  }
+
+  if (peers_.empty()) return false;
+
+  for (size_t i = 0; i < peers_.size(); ++i) {
+    auto* data = static_cast<char*>(malloc(4));
+    data[0] = static_cast<char>(GAME_READY + 'a');
+    data[1] = 'l';
+    data[2] = static_cast<char>('0' + i);
+    data[3] = static_cast<char>('0' + peers_.size());
+    peers_[i]->pushEvent({data, 4});
+  }
+
+  return true;
+}
+
+void Server::handleLockstep(Server::ServerClient* sender, const char* message,
+                            const int length) {
+  uint8_t slot = 0;
+  while (slot < peers_.size() && peers_[slot] != sender) ++slot;
+  if (slot == peers_.size()) return;
+
+  const auto type = static_cast<int>(message[0] - 'a');
+  if (type == INPUT_FRAME && length >= Protocol::INPUT_FRAME_LENGTH) {
+    // Relay the input as it is, appending the sender's slot
+    char relay[Protocol::INPUT_FRAME_LENGTH + 1];
+    memcpy(relay, message, Protocol::INPUT_FRAME_LENGTH);
+    relay[Protocol::INPUT_FRAME_LENGTH] = static_cast<char>('0' + slot);
+    broadcastPeers(relay, sizeof relay);
+    return;
+  }
+
+  if (type != CHECKSUM || length < Protocol::CHECKSUM_MESSAGE_LENGTH) return;
+
+  const auto frame = static_cast<uint32_t>(
+      Protocol::readNumber(message, 1, Protocol::FRAME_LENGTH));
+  const auto checksum = static_cast<uint32_t>(Protocol::readNumber(
+      message, 1 + Protocol::FRAME_LENGTH, Protocol::CHECKSUM_LENGTH, true));
+
+  const auto bit = static_cast<uint8_t>(1u << slot);
+  auto it = checksums_.find(frame);
+  if (it == checksums_.end()) {
+    it = checksums_.insert({frame, {checksum, 0}}).first;
+  } else if ((it->second.reported & bit) != 0) {
+    // A peer reporting the same frame twice doesn't count for the others
+    return;
+  } else if (it->second.checksum != checksum && !desynced_) {
+    desynced_ = true;
+    printf("Lockstep desync at frame %u\n", frame);
+
+    char desyncMessage[Protocol::DESYNC_LENGTH];
+    desyncMessage[0] = static_cast<char>(DESYNC + 'a');
+    Protocol::writeNumber(desyncMessage, frame, 1, Protocol::FRAME_LENGTH);
+    broadcastPeers(desyncMessage, sizeof desyncMessage);
+  }
+
+  // Every player reported the frame, so it won't be compared again
+  it->second.reported = static_cast<uint8_t>(it->second.reported | bit);
+  if (it->second.reported == (1u << peers_.size()) - 1) checksums_.erase(it);
+}
+
 int Server::getRunning() { return SDL_AtomicGet(&running_); }
 
 SDL_mutex* Server::getMutex() {
@@ -395,7 +621,7 @@ SDL_mutex* Server::getMutex() {
 }
 
 void Server::pushEvent(const Server::server_event_data_t& event) {
-  if (SDL_LockMutex(getMutex())) {
+  if (SDL_LockMutex(getMutex()) == 0) {
     events_.push(event);
     SDL_UnlockMutex(event_mutex_);
   } else {
@@ -404,8 +630,11 @@ void Server::pushEvent(const Server::server_event_data_t& event) {
 }
 
 int Server::clientPollEvent(Server::server_event_data_t* event) {
-  if (SDL_LockMutex(getMutex())) {
-    if (events_.empty()) return 0;
+  if (SDL_LockMutex(getMutex()) == 0) {
+    if (events_.empty()) {
+      SDL_UnlockMutex(event_mutex_);
+      return 0;
+    }
     *event = events_.front();
     events_.pop();
 
@@ -419,6 +648,32 @@ int Server::clientPollEvent(Server::server_event_data_t* event) {
 
 void Server::broadcast(char* message, int length) {
   for (auto& client : clients_) {
-    client->pushEvent({message, length});
+    // Each client owns a copy, as it is sent later from its own thread
+    auto* data = static_cast<char*>(malloc(static_cast<size_t>(length)));
+    memcpy(data, message, static_cast<size_t>(length));
+    client->pushEvent({data, length});
+  }
+}
+
+void Server::broadcastPeers(const char* message, const int length) {
+  for (auto& client : peers_) {
+    auto* data = static_cast<char*>(malloc(static_cast<size_t>(length)));
+    memcpy(data, message, static_cast<size_t>(length));
+    client->pushEvent({data, length});
+  }
+}
+
+std::vector<NetworkStats::snapshot_t> Server::getStats() const {
+  std::vector<NetworkStats::snapshot_t> stats;
+  if (SDL_LockMutex(getMutex()) != 0) {
+    fprintf(stderr, "Couldn't lock mutex: %s", SDL_GetError());
+    return stats;
+  }
+
+  stats.reserve(clients_.size());
+  for (const auto client : clients_) {
+    if (client->isRunning()) stats.push_back(client->getStats().getSnapshot());
   }
+  SDL_UnlockMutex(event_mutex_);
+  return stats;
 }
@@ -1,10 +1,12 @@
 #pragma once
 
 #include <array>
+#include <map>
 #include <queue>
 #include <string>
 #include <vector>
 
+#include "NetworkStats.h"
 #include "SDL.h"
 #include "SDL_net.h"
 
@@ -31,8 +33,8 @@ class Server {
     float direction;
     float speed;
     bool alive;
-    time_t availableShoot;
-    time_t availableRevive;
+    Uint64 availableShoot;
+    Uint64 availableRevive;
   } player_t;
 
   typedef struct {
@@ -41,7 +43,7 @@ class Server {
     float y;
     float direction;
     float speed;
-    time_t expires;
+    Uint64 expires;
   } bullet_t;
 
   class ServerGame {
@@ -100,11 +102,39 @@ class Server {
     ClientStatus status_ = ClientStatus::PENDING;
     IPaddress* remoteIP_ = nullptr;
     TCPsocket socket_;
+    SDLNet_SocketSet socketSet_ = nullptr;
+    std::string outgoing_{};
+    std::string incoming_{};
     SDL_mutex* event_mutex_ = nullptr;
     std::queue<client_event_data_t> events_;
+    NetworkStats stats_{};
 
     void initialize();
 
+    /**
+     * \brief Writes a message into the socket, terminated by
+     * `Protocol::MESSAGE_END`, accounting its size.
+     * \return The amount of bytes sent.
+     */
+    int send(const char* message, int length);
+
+    /**
+     * \brief Handles a single message split from the stream.
+     * \param message The message, null-terminated in place of its
+     * terminator.
+     * \param length The message's length.
+     * \return Whether or not the client asked to disconnect.
+     */
+    bool handleMessage(char* message, int length);
+
+    void sendPing();
+
+    /**
+     * \brief Handles the connection's own messages, such as pings and pongs.
+     * \return Whether or not the message was consumed.
+     */
+    bool handleControl(const char* message, int length);
+
     explicit ServerClient(TCPsocket socket);
 
     /**
@@ -131,10 +161,17 @@ class Server {
 
     void pushEvent(const client_event_data_t& event);
 
+    const NetworkStats& getStats() const;
+
     static int create(TCPsocket socket);
   };
 
-  enum ServerEventDataType { CONNECT, DISCONNECT };
+  /**
+   * \brief The events pushed by the client threads. `MESSAGE` carries a
+   * null-terminated copy of a message to handle in the main thread, which the
+   * handler frees.
+   */
+  enum ServerEventDataType { CONNECT, DISCONNECT, MESSAGE };
 
   typedef struct {
     ServerEventDataType type;
@@ -142,7 +179,14 @@ class Server {
     void* data;
   } server_event_data_t;
 
+  typedef struct {
+    uint32_t checksum;
+    uint8_t reported;
+  } checksum_t;
+
   static Server* instance_;
+  static Uint16 port_;
+  static bool lockstep_;
   static SDL_atomic_t running_;
   static SDL_mutex* event_mutex_;
   static std::queue<server_event_data_t> events_;
@@ -152,6 +196,18 @@ class Server {
   bool done_ = false;
   ServerGame* game_;
 
+  /**
+   * \brief The players of the lockstep match, indexed by slot.
+   */
+  std::vector<ServerClient*> peers_{};
+
+  /**
+   * \brief The checksums reported for each frame, with a bit set for each peer
+   * slot that reported it, until every peer did.
+   */
+  std::map<uint32_t, checksum_t> checksums_{};
+  bool desynced_ = false;
+
   /**
    *  \brief Polls for currently pending events.
    *
@@ -163,6 +219,17 @@ class Server {
    */
   static int clientPollEvent(server_event_data_t* event);
 
+  /**
+   * \brief Relays the inputs and compares the checksums of the lockstep
+   * match.
+   */
+  void handleLockstep(ServerClient* sender, const char* message, int length);
+
+  /**
+   * \brief Sends a message to every player of the lockstep match.
+   */
+  void broadcastPeers(const char* message, int length);
+
   Server();
 
  public:
@@ -172,11 +239,40 @@ class Server {
 
   static Server* getInstance();
 
+  /**
+   * \brief Sets the port to listen on, must be called before the instance is
+   * created. Defaults to `SERVER_PORT`.
+   */
+  static void setPort(Uint16 port);
+
+  /**
+   * \brief Makes games run in lockstep: the players only exchange their
+   * inputs through the server, and simulate the game themselves. Must be
+   * called before the instance is created.
+   */
+  static void setLockstep(bool lockstep);
+
+  static bool isLockstep();
+
+  /**
+   * \brief Starts a lockstep match with every connected client, sending each
+   * one its slot.
+   * \return Whether or not the match started.
+   */
+  bool startLockstep();
+
   static int getRunning();
 
   static SDL_mutex* getMutex();
 
   void broadcast(char* message, int length);
 
+  /**
+   * \brief Get the measurements of every connected client, guarded by
+   * `Server::getMutex()` so it can be called from any thread.
+   * \return The round-trip time, jitter, and throughput of each connection.
+   */
+  std::vector<NetworkStats::snapshot_t> getStats() const;
+
   static void pushEvent(const server_event_data_t& event);
 };
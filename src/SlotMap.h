@@ -0,0 +1,127 @@
+#pragma once
+#include <vector>
+
+#include "SDL.h"
+
+/**
+ * \brief The SlotMap class that stores values behind generational handles.
+ * Inserting, looking up and erasing are constant time, and a handle whose
+ * value was erased is detected as stale instead of dangling, even after its
+ * slot is reused.
+ * \tparam T The value type, which must be default constructible.
+ */
+template <class T>
+class SlotMap final {
+ public:
+  /**
+   * \brief The handle to a value. Generations start at 1, so a
+   * value-initialized handle never refers to anything.
+   */
+  typedef struct {
+    Uint32 index;
+    Uint32 generation;
+  } handle_t;
+
+ private:
+  typedef struct {
+    T value;
+    Uint32 generation;
+    bool used;
+  } slot_t;
+
+  std::vector<slot_t> slots_{};
+  std::vector<Uint32> free_{};
+  size_t size_ = 0;
+
+ public:
+  /**
+   * \brief Stores a value, reusing a free slot if there is any.
+   * \param value The value to store.
+   * \return The handle to the value.
+   */
+  handle_t insert(const T& value) {
+    ++size_;
+    if (free_.empty()) {
+      slots_.push_back({value, 1, true});
+      return {static_cast<Uint32>(slots_.size() - 1), 1};
+    }
+
+    const auto index = free_.back();
+    free_.pop_back();
+    auto& slot = slots_[index];
+    slot.value = value;
+    slot.used = true;
+    return {index, slot.generation};
+  }
+
+  /**
+   * \return Whether or not the handle refers to a stored value.
+   */
+  bool contains(const handle_t& handle) const {
+    return handle.index < slots_.size() && slots_[handle.index].used &&
+           slots_[handle.index].generation == handle.generation;
+  }
+
+  /**
+   * \return The value the handle refers to, or nullptr if it is stale.
+   */
+  T* get(const handle_t& handle) {
+    return contains(handle) ? &slots_[handle.index].value : nullptr;
+  }
+
+  /**
+   * \return The value the handle refers to, or nullptr if it is stale.
+   */
+  const T* get(const handle_t& handle) const {
+    return contains(handle) ? &slots_[handle.index].value : nullptr;
+  }
+
+  /**
+   * \brief Erases the value the handle refers to, making every copy of the
+   * handle stale.
+   * \return Whether or not a value was erased, false for stale handles.
+   */
+  bool erase(const handle_t& handle) {
+    if (!contains(handle)) return false;
+
+    auto& slot = slots_[handle.index];
+    slot.value = T{};
+    slot.used = false;
+    ++slot.generation;
+    free_.push_back(handle.index);
+    --size_;
+    return true;
+  }
+
+  /**
+   * \brief Erases every value.
+   */
+  void clear() {
+    for (Uint32 i = 0; i < slots_.size(); ++i) {
+      auto& slot = slots_[i];
+      if (!slot.used) continue;
+
+      slot.value = T{};
+      slot.used = false;
+      ++slot.generation;
+      free_.push_back(i);
+    }
+    size_ = 0;
+  }
+
+  /**
+   * \return The amount of values stored.
+   */
+  size_t size() const { return size_; }
+
+  /**
+   * \brief Calls a function with every stored value, in no particular order.
+   * \param callback A function taking a reference to the value.
+   */
+  template <class F>
+  void each(F callback) {
+    for (auto& slot : slots_) {
+      if (slot.used) callback(slot.value);
+    }
+  }
+};
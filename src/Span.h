@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+/**
+ * \brief The Span class that views a contiguous range of values it does not
+ * own, so containers can be handed out without copying them. A span is only
+ * valid while the container it views is not modified.
+ * \tparam T The value type, const qualified for read-only views.
+ */
+template <class T>
+class Span final {
+  T* data_ = nullptr;
+  size_t size_ = 0;
+
+ public:
+  Span() = default;
+  Span(T* data, const size_t size) : data_(data), size_(size) {}
+
+  /**
+   * \brief Views the whole contents of a vector.
+   */
+  template <class U>
+  Span(const std::vector<U>& vector)
+      : data_(vector.data()), size_(vector.size()) {}
+
+  template <class U>
+  Span(std::vector<U>& vector) : data_(vector.data()), size_(vector.size()) {}
+
+  T* begin() const { return data_; }
+  T* end() const { return data_ + size_; }
+  T* data() const { return data_; }
+  T& operator[](const size_t index) const { return data_[index]; }
+  T& front() const { return data_[0]; }
+  T& back() const { return data_[size_ - 1]; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+};
@@ -0,0 +1,238 @@
+#pragma once
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "SDL.h"
+
+/**
+ * \brief The SpatialGrid class that indexes rectangles into square cells, so
+ * point and rectangle queries only look at the values stored in the cells
+ * they touch instead of at every value. Each value also has an order, and
+ * queries return the values on top first.
+ * \tparam T The value type, which must be hashable.
+ */
+template <class T>
+class SpatialGrid final {
+  typedef struct {
+    T value;
+    SDL_Rect rect;
+    Uint64 order;
+    /**
+     * \brief The range of cells the rectangle covers, inclusive.
+     */
+    int left;
+    int top;
+    int right;
+    int bottom;
+    /**
+     * \brief The last query that returned the entry, so values spanning
+     * several cells are only returned once per query.
+     */
+    Uint32 stamp;
+  } entry_t;
+
+  int cellSize_;
+  std::vector<entry_t> entries_{};
+  std::vector<Uint32> free_{};
+  std::unordered_map<T, Uint32> ids_{};
+
+  /**
+   * \brief The entries of each cell, sorted by order.
+   */
+  std::unordered_map<Uint64, std::vector<Uint32>> cells_{};
+  Uint32 stamp_ = 0;
+  std::vector<Uint32> found_{};
+
+  static Uint64 keyOf(const int x, const int y) {
+    return static_cast<Uint64>(static_cast<Uint32>(x)) << 32 |
+           static_cast<Uint32>(y);
+  }
+
+  /**
+   * \return The cell a coordinate falls into, rounding down for negatives.
+   */
+  int cellOf(const int coordinate) const {
+    return coordinate >= 0 ? coordinate / cellSize_
+                           : (coordinate + 1) / cellSize_ - 1;
+  }
+
+  void link(const Uint32 id) {
+    auto& entry = entries_[id];
+    entry.left = cellOf(entry.rect.x);
+    entry.top = cellOf(entry.rect.y);
+    entry.right = cellOf(entry.rect.x + entry.rect.w - 1);
+    entry.bottom = cellOf(entry.rect.y + entry.rect.h - 1);
+
+    const auto byOrder = [this](const Uint32 a, const Uint32 b) {
+      return entries_[a].order < entries_[b].order;
+    };
+    for (auto y = entry.top; y <= entry.bottom; ++y) {
+      for (auto x = entry.left; x <= entry.right; ++x) {
+        auto& cell = cells_[keyOf(x, y)];
+        cell.insert(std::upper_bound(cell.begin(), cell.end(), id, byOrder),
+                    id);
+      }
+    }
+  }
+
+  void unlink(const Uint32 id) {
+    const auto& entry = entries_[id];
+    for (auto y = entry.top; y <= entry.bottom; ++y) {
+      for (auto x = entry.left; x <= entry.right; ++x) {
+        const auto it = cells_.find(keyOf(x, y));
+        if (it == cells_.end()) continue;
+
+        auto& cell = it->second;
+        cell.erase(std::find(cell.begin(), cell.end(), id));
+        if (cell.empty()) cells_.erase(it);
+      }
+    }
+  }
+
+ public:
+  /**
+   * \param cellSize The side of each cell, which works best around the size
+   * of the values' rectangles.
+   */
+  explicit SpatialGrid(const int cellSize) : cellSize_(cellSize) {}
+
+  /**
+   * \brief Stores a value, or moves it if it was already stored. Values with
+   * an empty rectangle cannot be found, so they are erased instead.
+   * \param value The value to store.
+   * \param rect The area the value covers.
+   * \param order Where the value is stacked, higher orders are on top.
+   */
+  void insert(const T& value, const SDL_Rect& rect, const Uint64 order) {
+    if (SDL_RectEmpty(&rect)) {
+      erase(value);
+      return;
+    }
+
+    const auto it = ids_.find(value);
+    if (it != ids_.end()) {
+      auto& entry = entries_[it->second];
+      if (entry.order == order && SDL_RectEquals(&entry.rect, &rect)) return;
+
+      unlink(it->second);
+      entry.rect = rect;
+      entry.order = order;
+      link(it->second);
+      return;
+    }
+
+    Uint32 id;
+    if (free_.empty()) {
+      id = static_cast<Uint32>(entries_.size());
+      entries_.push_back({value, rect, order, 0, 0, 0, 0, 0});
+    } else {
+      id = free_.back();
+      free_.pop_back();
+      entries_[id] = {value, rect, order, 0, 0, 0, 0, 0};
+    }
+
+    ids_.insert({value, id});
+    link(id);
+  }
+
+  /**
+   * \brief Moves a stored value, keeping its order.
+   * \return Whether or not the value was stored.
+   */
+  bool update(const T& value, const SDL_Rect& rect) {
+    const auto it = ids_.find(value);
+    if (it == ids_.end()) return false;
+
+    insert(value, rect, entries_[it->second].order);
+    return true;
+  }
+
+  /**
+   * \brief Erases a value, doing nothing if it was not stored.
+   */
+  void erase(const T& value) {
+    const auto it = ids_.find(value);
+    if (it == ids_.end()) return;
+
+    unlink(it->second);
+    entries_[it->second].value = T{};
+    free_.push_back(it->second);
+    ids_.erase(it);
+  }
+
+  /**
+   * \brief Erases every value.
+   */
+  void clear() {
+    entries_.clear();
+    free_.clear();
+    ids_.clear();
+    cells_.clear();
+  }
+
+  /**
+   * \return Whether or not the value is stored.
+   */
+  bool contains(const T& value) const { return ids_.count(value) != 0; }
+
+  /**
+   * \return The amount of values stored.
+   */
+  size_t size() const { return ids_.size(); }
+
+  /**
+   * \brief Finds the values whose rectangle contains a point.
+   * \param point The point to look for.
+   * \param result Filled with the values found, from the top down.
+   */
+  void query(const SDL_Point& point, std::vector<T>& result) const {
+    result.clear();
+    const auto it = cells_.find(keyOf(cellOf(point.x), cellOf(point.y)));
+    if (it == cells_.end()) return;
+
+    for (auto id = it->second.rbegin(); id != it->second.rend(); ++id) {
+      const auto& entry = entries_[*id];
+      if (SDL_PointInRect(&point, &entry.rect)) result.push_back(entry.value);
+    }
+  }
+
+  /**
+   * \brief Finds the values whose rectangle intersects another.
+   * \param rect The area to look in.
+   * \param result Filled with the values found, from the top down.
+   */
+  void query(const SDL_Rect& rect, std::vector<T>& result) {
+    result.clear();
+    if (SDL_RectEmpty(&rect)) return;
+
+    // The stamp tells apart the entries this query already visited
+    if (++stamp_ == 0) {
+      for (auto& entry : entries_) entry.stamp = 0;
+      stamp_ = 1;
+    }
+
+    found_.clear();
+    const auto right = cellOf(rect.x + rect.w - 1);
+    const auto bottom = cellOf(rect.y + rect.h - 1);
+    for (auto y = cellOf(rect.y); y <= bottom; ++y) {
+      for (auto x = cellOf(rect.x); x <= right; ++x) {
+        const auto it = cells_.find(keyOf(x, y));
+        if (it == cells_.end()) continue;
+
+        for (const auto id : it->second) {
+          auto& entry = entries_[id];
+          if (entry.stamp == stamp_) continue;
+
+          entry.stamp = stamp_;
+          if (SDL_HasIntersection(&rect, &entry.rect)) found_.push_back(id);
+        }
+      }
+    }
+
+    std::sort(found_.begin(), found_.end(), [this](Uint32 a, Uint32 b) {
+      return entries_[a].order > entries_[b].order;
+    });
+    for (const auto id : found_) result.push_back(entries_[id].value);
+  }
+};
@@ -0,0 +1,27 @@
+#include "SpriteSystem.h"
+
+#include "Camera.h"
+#include "Components.h"
+#include "Texture.h"
+#include "World.h"
+
+void SpriteSystem::render(World& world, const Camera& camera,
+                          const double interpolation) {
+  const auto alpha = static_cast<float>(interpolation);
+  world.each<position_t, sprite_t>([alpha, &camera](const World::entity_t&,
+                                                    const position_t& position,
+                                                    const sprite_t& sprite) {
+    if (sprite.texture == nullptr) return;
+
+    const auto x =
+        position.previousX + (position.x - position.previousX) * alpha;
+    const auto y =
+        position.previousY + (position.y - position.previousY) * alpha;
+    const SDL_Rect rect{static_cast<int>(x) - sprite.width / 2,
+                        static_cast<int>(y) - sprite.height / 2, sprite.width,
+                        sprite.height};
+    if (!camera.isVisible(rect)) return;
+    sprite.texture->renderFrame(camera.toScreen(rect), sprite.frame, 0,
+                                sprite.layer);
+  });
+}
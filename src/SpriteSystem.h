@@ -0,0 +1,12 @@
+#pragma once
+#include "System.h"
+
+/**
+ * \brief The SpriteSystem class that draws every entity with a position and a
+ * sprite, interpolated between the last two simulation steps.
+ */
+class SpriteSystem final : public System {
+ public:
+  void render(World& world, const Camera& camera,
+              double interpolation) override;
+};
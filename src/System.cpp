@@ -0,0 +1,10 @@
+#include "System.h"
+
+#include "Camera.h"
+#include "World.h"
+
+void System::update(World&, double) {}
+
+void System::render(World&, const Camera&, double) {}
+
+bool System::isConcurrent() const { return false; }
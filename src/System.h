@@ -0,0 +1,42 @@
+#pragma once
+
+class Camera;
+class World;
+
+/**
+ * \brief The System class that runs the logic of every entity with a given
+ * set of components, sweeping them through World::each(). Systems are owned
+ * by a Scene, which updates them after its GameObject instances.
+ */
+class System {
+ public:
+  /**
+   * \brief Destruct this System.
+   */
+  virtual ~System() = default;
+
+  /**
+   * \brief Advances the entities by one simulation step.
+   * \param world The scene's entities.
+   * \param step The step's duration in seconds.
+   */
+  virtual void update(World& world, double step);
+
+  /**
+   * \brief Draws the entities, before the scene's GameObject instances.
+   * \param world The scene's entities.
+   * \param camera The scene's view, to skip the entities out of it.
+   * \param interpolation How far the frame is between the last simulation
+   * step and the next one, from 0 to 1.
+   */
+  virtual void render(World& world, const Camera& camera,
+                      double interpolation);
+
+  /**
+   * \brief Whether or not the system may update on a worker thread at the
+   * same time as the systems next to it, which holds when it only writes
+   * components no other concurrent system touches.
+   * \return False by default, so the system updates alone on the main thread.
+   */
+  virtual bool isConcurrent() const;
+};
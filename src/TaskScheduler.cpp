@@ -0,0 +1,115 @@
+#include "TaskScheduler.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "Clock.h"
+
+namespace {
+template <class A, class B>
+bool precedes(const A& a, const B& b) {
+  if (a.priority != b.priority) return a.priority < b.priority;
+  return a.sequence < b.sequence;
+}
+}  // namespace
+
+TaskScheduler::TaskScheduler(FrameArena& arena) : arena_(arena), next_(arena) {}
+
+TaskScheduler::~TaskScheduler() {
+  for (const auto& task : next_) task.run.destroy();
+}
+
+void TaskScheduler::add(TaskScheduler::task_t task, const Uint32 frames,
+                        const Uint32 milliseconds) {
+  task.sequence = sequence_++;
+  task.frame = frame_ + (frames > 0 ? frames : 1);
+  task.time = Clock::nanoseconds() + Uint64{milliseconds} * 1000000;
+  tasks_.push_back(std::move(task));
+}
+
+void TaskScheduler::scheduleInFrames(const Uint32 frames,
+                                     std::function<void()> task,
+                                     const TaskPriority priority) {
+  add({std::move(task), nullptr, priority, 0, 0, 0}, frames, 0);
+}
+
+void TaskScheduler::scheduleInMilliseconds(const Uint32 milliseconds,
+                                           std::function<void()> task,
+                                           const TaskPriority priority) {
+  add({std::move(task), nullptr, priority, 0, 0, 0}, 1, milliseconds);
+}
+
+void TaskScheduler::scheduleResumable(std::function<bool()> task,
+                                      const TaskPriority priority) {
+  add({nullptr, std::move(task), priority, 0, 0, 0}, 1, 0);
+}
+
+void TaskScheduler::detach(const TaskScheduler::arena_task_t& task) {
+  tasks_.push_back({task.run.detach(), nullptr, task.priority, task.sequence,
+                    frame_ + 1, 0});
+}
+
+void TaskScheduler::run(const Uint64 budget) {
+  ++frame_;
+  if (tasks_.empty() && next_.empty()) return;
+
+  // Tasks scheduled while running go to the emptied queues, for the next step
+  running_.swap(tasks_);
+  std::sort(running_.begin(), running_.end(), precedes<task_t, task_t>);
+  ArenaVector<arena_task_t> next(arena_);
+  for (const auto& task : next_) next.push_back(task);
+  next_.clear();
+  std::sort(next.begin(), next.end(), precedes<arena_task_t, arena_task_t>);
+
+  // Both queues are sorted, so merging them keeps the order across them
+  const auto start = Clock::nanoseconds();
+  auto ran = false;
+  size_t i = 0;
+  size_t j = 0;
+  while (i < running_.size() || j < next.size()) {
+    const auto now = Clock::nanoseconds();
+    if (j < next.size() &&
+        (i == running_.size() || precedes(next[j], running_[i]))) {
+      const auto task = next[j++];
+      if (ran && now - start >= budget && task.priority != TaskPriority::HIGH) {
+        detach(task);
+        continue;
+      }
+
+      ran = true;
+      task.run();
+      task.run.destroy();
+      continue;
+    }
+
+    auto& task = running_[i++];
+    const auto due = task.frame <= frame_ && task.time <= now;
+    const auto spent = ran && now - start >= budget &&
+                       task.priority != TaskPriority::HIGH;
+    if (!due || spent) {
+      tasks_.push_back(std::move(task));
+      continue;
+    }
+
+    ran = true;
+    if (task.run) {
+      task.run();
+    } else if (!task.step()) {
+      tasks_.push_back(std::move(task));
+    }
+  }
+  running_.clear();
+}
+
+void TaskScheduler::persist() {
+  for (const auto& task : next_) detach(task);
+  next_.clear();
+}
+
+void TaskScheduler::clear() {
+  for (const auto& task : next_) task.run.destroy();
+  next_.clear();
+  tasks_.clear();
+}
+
+size_t TaskScheduler::size() const { return tasks_.size() + next_.size(); }
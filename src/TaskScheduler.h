@@ -0,0 +1,139 @@
+#pragma once
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "FrameArena.h"
+#include "SDL.h"
+
+/**
+ * \brief The order due tasks run in. High priority tasks also run past the
+ * budget, so they always run on the step they are due.
+ */
+enum class TaskPriority { HIGH, NORMAL, LOW };
+
+/**
+ * \brief The TaskScheduler class that runs deferred work within a time budget
+ * per simulation step. Due tasks run by priority, then in the order they were
+ * scheduled, until the budget is spent, and the rest roll over to the next
+ * step. Tasks can wait a number of steps or milliseconds, and long ones can
+ * be split into parts that yield between steps.
+ *
+ * Tasks for the next step are stored in a FrameArena, so scheduling them does
+ * not allocate. Only tasks that wait, yield, or roll over are moved to the
+ * heap, as they outlive the frame.
+ *
+ * \note Whether a task runs on a step depends on how fast the machine is, so
+ * tasks that change lockstep state must be high priority.
+ */
+class TaskScheduler final {
+  typedef struct {
+    /**
+     * \brief The task, when it runs at once.
+     */
+    std::function<void()> run;
+    /**
+     * \brief The task, when it yields, which returns whether it finished.
+     */
+    std::function<bool()> step;
+    TaskPriority priority;
+    Uint64 sequence;
+    /**
+     * \brief The step and the time in nanoseconds the task is due at.
+     */
+    Uint64 frame;
+    Uint64 time;
+  } task_t;
+
+  typedef struct {
+    ArenaCallback run;
+    TaskPriority priority;
+    Uint64 sequence;
+  } arena_task_t;
+
+  FrameArena& arena_;
+
+  /**
+   * \brief The tasks for the next step, until they run or outlive the frame.
+   */
+  ArenaVector<arena_task_t> next_;
+  std::vector<task_t> tasks_;
+  std::vector<task_t> running_;
+  Uint64 frame_ = 0;
+  Uint64 sequence_ = 0;
+
+  void add(task_t task, Uint32 frames, Uint32 milliseconds);
+
+  /**
+   * \brief Moves a task out of the arena into the heap-backed queue, due on
+   * the next step.
+   */
+  void detach(const arena_task_t& task);
+
+ public:
+  /**
+   * \param arena The arena the tasks for the next step are stored in.
+   */
+  explicit TaskScheduler(FrameArena& arena);
+  ~TaskScheduler();
+  TaskScheduler(const TaskScheduler&) = delete;  // Copy Constructor
+  TaskScheduler(TaskScheduler&&) = delete;       // Move Constructor
+  TaskScheduler& operator=(const TaskScheduler&) =
+      delete;  // Assignment Operator
+  TaskScheduler& operator=(TaskScheduler&&) = delete;  // Move Operator
+
+  /**
+   * \brief Runs a task on the next step, storing it in the frame arena.
+   * \param task A function taking no arguments.
+   */
+  template <class F>
+  void schedule(F task, TaskPriority priority = TaskPriority::NORMAL) {
+    next_.push_back({ArenaCallback(arena_, std::move(task)), priority,
+                     sequence_++});
+  }
+
+  /**
+   * \brief Runs a task once an amount of steps has passed.
+   */
+  void scheduleInFrames(Uint32 frames, std::function<void()> task,
+                        TaskPriority priority = TaskPriority::NORMAL);
+
+  /**
+   * \brief Runs a task once an amount of time has passed.
+   */
+  void scheduleInMilliseconds(Uint32 milliseconds, std::function<void()> task,
+                              TaskPriority priority = TaskPriority::NORMAL);
+
+  /**
+   * \brief Runs a task split into parts, one part per call, from the next
+   * step on. The task keeps its place in the queue while it yields.
+   * \param task Runs the next part, and returns whether it was the last one.
+   */
+  void scheduleResumable(std::function<bool()> task,
+                         TaskPriority priority = TaskPriority::NORMAL);
+
+  /**
+   * \brief Runs the due tasks, which is one simulation step. Tasks scheduled
+   * meanwhile wait for the next step.
+   * \param budget The nanoseconds the tasks may take, though at least one
+   * task runs so every task eventually does.
+   */
+  void run(Uint64 budget);
+
+  /**
+   * \brief Moves the tasks still waiting in the frame arena to the heap, must
+   * be called before the arena resets.
+   */
+  void persist();
+
+  /**
+   * \brief Drops every pending task, though when called from a task, the
+   * other tasks of the step still run.
+   */
+  void clear();
+
+  /**
+   * \return The amount of tasks waiting to run, including yielded ones.
+   */
+  size_t size() const;
+};
@@ -1,10 +1,13 @@
 #include "Texture.h"
 
+#include "Clock.h"
 #include "Font.h"
+#include "FramePacer.h"
+#include "Game.h"
+#include "RenderQueue.h"
 #include "SDLError.h"
 #include "SDL_image.h"
 #include "TextureManager.h"
-#include "TimePool.h"
 
 Texture::Texture() : size_(0, 0), frameSize_(0, 0), offset_(0, 0) {}
 
@@ -28,7 +31,9 @@ Vector2D<Uint16> Texture::getCalculatedSize() const {
 
 Vector2D<Uint16> Texture::getFrameSize() const { return frameSize_; }
 
-std::vector<Uint16> Texture::getAnimation() const { return animation_.frames; }
+const std::vector<Uint16>& Texture::getAnimation() const {
+  return animation_.frames;
+}
 
 Vector2D<int> Texture::getOffset() const { return offset_; }
 
@@ -46,7 +51,7 @@ SDL_RendererFlip Texture::getFlip() const { return flip_; }
 Texture::~Texture() {
   close();
   animations_.clear();
-  delete pool_;
+  delete pacer_;
 }
 
 Vector2D<Uint16> Texture::getFramePosition(const Uint16 frame) const {
@@ -100,8 +105,15 @@ Texture* Texture::loadFromImage(const std::string& filename,
     throw SDLError(message);
   }
 
+  loadFromSurface(surface, rowAmount, columnAmount);
+  SDL_FreeSurface(surface);
+  return this;
+}
+
+Texture* Texture::loadFromSurface(SDL_Surface* surface, const Uint16 rowAmount,
+                                  const Uint16 columnAmount) {
   close();
-  texture_ = SDL_CreateTextureFromSurface(renderer_, surface);
+  texture_ = Game::getRenderBackend()->createTexture(surface);
   if (texture_ != nullptr) {
     size_.set(static_cast<Uint16>(surface->w), static_cast<Uint16>(surface->h));
     frameSize_.set(static_cast<Uint16>(surface->w / columnAmount),
@@ -109,7 +121,6 @@ Texture* Texture::loadFromImage(const std::string& filename,
     columnAmount_ = columnAmount;
     rowAmount_ = rowAmount;
   }
-  SDL_FreeSurface(surface);
   return this;
 }
 
@@ -124,7 +135,7 @@ Texture* Texture::loadFromText(Font* font, const std::string& text,
   }
 
   close();
-  texture_ = SDL_CreateTextureFromSurface(renderer_, surface);
+  texture_ = Game::getRenderBackend()->createTexture(surface);
   if (texture_ != nullptr) {
     size_.set(static_cast<Uint16>(surface->w), static_cast<Uint16>(surface->h));
     frameSize_.set(static_cast<Uint16>(surface->w),
@@ -148,14 +159,12 @@ Texture* Texture::addAnimation(const std::string& name,
 
 void Texture::setAnimation(const std::string& name) {
   if (hasAnimation(name)) {
-    const auto previous = animation_;
-    const auto next = animations_[name];
-    animation_ = next;
+    animation_ = animations_[name];
     frame_ = 0;
-    delete pool_;
-    pool_ = animation_.frameRate
-                ? new TimePool(1000 / animation_.frameRate, SDL_GetTicks())
-                : nullptr;
+    delete pacer_;
+    pacer_ = animation_.frameRate
+                 ? new FramePacer(FramePacer::fromRate(animation_.frameRate))
+                 : nullptr;
   } else {
     throw SnowShooterError(
         "Cannot set an animation that has not been previously added.");
@@ -176,10 +185,10 @@ bool Texture::hasAnimation(const std::string& name) const {
 }
 
 void Texture::tick() {
-  // If no pool is available, omit
-  if (pool_ == nullptr) return;
+  // If no pacer is available, omit
+  if (pacer_ == nullptr) return;
 
-  if (!pool_->next(SDL_GetTicks())) return;
+  if (!pacer_->isDue(Clock::nanoseconds())) return;
 
   const auto size = animation_.frames.size();
   // Requires at least two frames to "tick"
@@ -207,19 +216,19 @@ void Texture::render(const Vector2D<int>& position) const {
   render(rectangle);
 }
 
-void Texture::render(const SDL_Rect& dest, double, const SDL_Rect* clip) const {
+void Texture::render(const SDL_Rect& dest, double, const SDL_Rect* clip,
+                     const int layer) const {
   if (texture_ != nullptr) {
-    if (clip == nullptr) {
-      const auto size = getCalculatedSize();
-      SDL_Rect defaultClip = {0, 0, size.getX(), size.getY()};
-      clip = &defaultClip;
-    }
-    SDL_RenderCopy(renderer_, texture_, clip, &dest);
+    const auto size = getCalculatedSize();
+    const auto src =
+        clip != nullptr ? *clip : SDL_Rect{0, 0, size.getX(), size.getY()};
+    Game::getRenderQueue()->submit(
+        {texture_, src, dest, 0, SDL_FLIP_NONE, layer, 0});
   }
 }
 
 void Texture::renderFrame(const SDL_Rect& dest, const Uint16 frame,
-                          const double angle) const {
+                          const double angle, const int layer) const {
   auto framePosition = getFramePosition(frame);
   const auto width = frameSize_.getX();
   const auto height = frameSize_.getY();
@@ -238,7 +247,7 @@ void Texture::renderFrame(const SDL_Rect& dest, const Uint16 frame,
   out.y += offset_.getY();
   SDL_Rect src{width * framePosition.getX(), height * framePosition.getY(),
                width, height};
-  SDL_RenderCopyEx(renderer_, texture_, &src, &out, angle, nullptr, flip_);
+  Game::getRenderQueue()->submit({texture_, src, out, angle, flip_, layer, 0});
 }
 
 void Texture::close() {
@@ -9,7 +9,7 @@
 #include "Vector2D.h"
 
 class Font;
-class TimePool;
+class FramePacer;
 
 class Texture final {
   struct AnimationTextureInfo {
@@ -21,7 +21,7 @@ class Texture final {
   SDL_Texture* texture_ = nullptr;
   SDL_Renderer* renderer_ = nullptr;
 
-  TimePool* pool_ = nullptr;
+  FramePacer* pacer_ = nullptr;
 
   Vector2D<Uint16> size_;
   Vector2D<double> scale_{1, 1};
@@ -64,7 +64,7 @@ class Texture final {
 
   Vector2D<Uint16> getFramePosition(Uint16 frame) const;
 
-  std::vector<Uint16> getAnimation() const;
+  const std::vector<Uint16>& getAnimation() const;
 
   Vector2D<int> getOffset() const;
   // offset is set to size*percentage
@@ -76,6 +76,14 @@ class Texture final {
 
   Texture* loadFromImage(const std::string& filename, Uint16 rowAmount = 1,
                          Uint16 columnAmount = 1);
+
+  /**
+   * \brief Uploads an already decoded image, so the slow decoding can happen
+   * on another thread while this runs on the renderer's.
+   * \param surface The image, which is left for the caller to free.
+   */
+  Texture* loadFromSurface(SDL_Surface* surface, Uint16 rowAmount = 1,
+                           Uint16 columnAmount = 1);
   Texture* loadFromText(Font* font, const std::string& text,
                         SDL_Color color = {0, 0, 0, 255},
                         Uint32 lineJumpLimit = 250);
@@ -90,7 +98,14 @@ class Texture final {
   void tick();
   void render(const Vector2D<int>& position) const;
   void render(const SDL_Rect& dest, double angle = 0,
-              const SDL_Rect* clip = nullptr) const;
-  void renderFrame(const SDL_Rect& dest, Uint16 frame, double angle = 0) const;
+              const SDL_Rect* clip = nullptr, int layer = 0) const;
+
+  /**
+   * \brief Queues a frame to be drawn when the scene flushes the frame's
+   * RenderQueue.
+   * \param layer The layer to draw it on, higher layers are drawn on top.
+   */
+  void renderFrame(const SDL_Rect& dest, Uint16 frame, double angle = 0,
+                   int layer = 0) const;
   void close();
 };
\ No newline at end of file
@@ -1,9 +1,13 @@
 #include "TextureManager.h"
 
+#include "Constants.h"
 #include "Game.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "SDLError.h"
+#include "SDL_image.h"
 #include "SnowShooterError.h"
 #include "Texture.h"
-#include "TimePool.h"
 
 TextureManager* TextureManager::instance_ = nullptr;
 
@@ -20,30 +24,132 @@ TextureManager::TextureManager() = default;
 Texture* TextureManager::add(const std::string& name, const std::string& path,
                              const Uint16 columns, const Uint16 rows) {
   const auto texture = new Texture(Game::getRenderer());
-  texture->loadFromImage(path, rows, columns);
+  pending_.push_back({texture, path, columns, rows});
   map_.insert(std::pair<std::string, Texture*>(name, texture));
   return texture;
 }
 
 void TextureManager::init() {
-  for (const auto& pair : map_) {
-    const auto texture = pair.second;
-
-    // If there was no default animation override, add it
-    if (!texture->hasAnimation("default")) {
-      const Uint16 frames = static_cast<Uint16>(texture->getColumnAmount() *
-                                                texture->getRowAmount());
-      std::vector<Uint16> animation(frames);
-      for (Uint16 i = 0; i < frames; i++) animation[i] = i;
-      texture->addAnimation("default", animation);
+  // Decoding is the slow part and runs on the pool, but the textures must be
+  // created on the renderer's thread
+  std::vector<SDL_Surface*> surfaces(pending_.size(), nullptr);
+  std::vector<std::string> errors(pending_.size());
+  JobSystem::getInstance()->parallelFor(
+      pending_.size(), 1, [this, &surfaces, &errors](size_t begin, size_t) {
+        surfaces[begin] = IMG_Load(pending_[begin].path.c_str());
+        if (surfaces[begin] == nullptr) errors[begin] = SDL_GetError();
+      });
+
+  std::string error;
+  for (size_t i = 0; i < pending_.size(); ++i) {
+    const auto& pending = pending_[i];
+    if (surfaces[i] == nullptr) {
+      if (error.empty()) {
+        error = "Error loading surface from " + pending.path +
+                "\nReason: " + errors[i];
+      }
+      continue;
+    }
+
+    pending.texture->loadFromSurface(surfaces[i], pending.rows,
+                                     pending.columns);
+    SDL_FreeSurface(surfaces[i]);
+  }
+  pending_.clear();
+  if (!error.empty()) throw SDLError(error);
+
+  for (const auto& pair : map_) addDefaultAnimation(pair.second);
+}
+
+void TextureManager::addDefaultAnimation(Texture* texture) {
+  // If there was no default animation override, add it
+  if (!texture->hasAnimation("default")) {
+    const Uint16 frames = static_cast<Uint16>(texture->getColumnAmount() *
+                                              texture->getRowAmount());
+    std::vector<Uint16> animation(frames);
+    for (Uint16 i = 0; i < frames; i++) animation[i] = i;
+    texture->addAnimation("default", animation);
+  }
+
+  texture->setAnimation("default");
+}
+
+Texture* TextureManager::preload(const TextureManager::request_t& request) {
+  const auto it = map_.find(request.name);
+  if (it != map_.end()) return it->second;
+
+  const auto texture = new Texture(Game::getRenderer());
+  map_.insert(std::pair<std::string, Texture*>(request.name, texture));
+
+  // The job only decodes, the upload must happen on the renderer's thread
+  auto* loading = new loading_t();
+  loading->name = request.name;
+  loading->texture = texture;
+  loading->columns = request.columns;
+  loading->rows = request.rows;
+  const auto path = request.path;
+  loading->job = JobSystem::getInstance()->schedule([loading, path]() {
+    loading->surface = IMG_Load(path.c_str());
+    if (loading->surface == nullptr) {
+      loading->error =
+          "Error loading surface from " + path + "\nReason: " + SDL_GetError();
+    }
+  });
+  loading_.push_back(loading);
+  return texture;
+}
+
+void TextureManager::load(
+    const std::vector<TextureManager::request_t>& requests) {
+  for (const auto& request : requests) preload(request);
+
+  auto* jobs = JobSystem::getInstance();
+  for (const auto& request : requests) {
+    while (!isResident(request.name)) {
+      for (auto* loading : loading_) jobs->wait(loading->job);
+      upload();
     }
+  }
+}
 
-    texture->setAnimation("default");
+bool TextureManager::isResident(const std::string& name) const {
+  if (map_.find(name) == map_.end()) return false;
+  for (const auto* loading : loading_) {
+    if (loading->name == name) return false;
+  }
+  return true;
+}
+
+void TextureManager::upload() {
+  int uploads = 0;
+  for (auto it = loading_.begin(); it != loading_.end();) {
+    auto* loading = *it;
+    if (uploads == TEXTURE_UPLOADS_PER_FRAME ||
+        !JobSystem::isDone(loading->job)) {
+      ++it;
+      continue;
+    }
+
+    it = loading_.erase(it);
+    if (loading->surface == nullptr) {
+      const auto error = loading->error;
+      delete loading;
+      throw SDLError(error);
+    }
+
+    loading->texture->loadFromSurface(loading->surface, loading->rows,
+                                      loading->columns);
+    addDefaultAnimation(loading->texture);
+    SDL_FreeSurface(loading->surface);
+    delete loading;
+    ++uploads;
   }
 }
 
 void TextureManager::tick() {
+  PROFILE_ZONE("TextureManager::tick");
   if (instance_ == nullptr) return;
+  if (!loading_.empty()) upload();
   for (auto& pair : map_) {
     pair.second->tick();
   }
@@ -54,6 +160,14 @@ Texture* TextureManager::get(const std::string& name) {
 }
 
 TextureManager::~TextureManager() {
+  // The jobs write into their entries, so they are waited for before freeing
+  for (auto* loading : loading_) {
+    JobSystem::getInstance()->wait(loading->job);
+    if (loading->surface != nullptr) SDL_FreeSurface(loading->surface);
+    delete loading;
+  }
+  loading_.clear();
+
   for (auto& pair : map_) delete pair.second;
   map_.clear();
 }
@@ -1,20 +1,97 @@
 #pragma once
 #include <list>
 #include <map>
+#include <string>
+#include <vector>
 
+#include "JobSystem.h"
 #include "ResourceManager.h"
 
 class Texture;
-class TimePool;
 
 class TextureManager final : public ResourceManager<Texture*> {
+ public:
+  /**
+   * \brief A texture to load, as the arguments of TextureManager::add().
+   */
+  typedef struct {
+    std::string name;
+    std::string path;
+    Uint16 columns;
+    Uint16 rows;
+  } request_t;
+
+ private:
+  typedef struct {
+    Texture* texture;
+    std::string path;
+    Uint16 columns;
+    Uint16 rows;
+  } pending_t;
+
   static TextureManager* instance_;
+
+  /**
+   * \brief The images added since the last TextureManager::init(), which
+   * decodes them all at once on the job system.
+   */
+  std::vector<pending_t> pending_;
+
+  /**
+   * \brief A texture being preloaded, whose image is decoded by a job and
+   * then uploaded by TextureManager::tick().
+   */
+  typedef struct {
+    std::string name;
+    Texture* texture;
+    Uint16 columns;
+    Uint16 rows;
+    JobSystem::job_t job;
+    SDL_Surface* surface;
+    std::string error;
+  } loading_t;
+
+  std::vector<loading_t*> loading_;
   TextureManager();
   ~TextureManager();
 
+  /**
+   * \brief Uploads the preloaded images that finished decoding, at most
+   * TEXTURE_UPLOADS_PER_FRAME of them.
+   */
+  void upload();
+  static void addDefaultAnimation(Texture* texture);
+
  public:
+  /**
+   * \brief Adds a texture whose image is loaded by the next
+   * TextureManager::init(), so every image is decoded in parallel.
+   * \return The texture, which is empty until then.
+   */
   Texture* add(const std::string& name, const std::string& path, Uint16 columns,
                Uint16 rows);
+
+  /**
+   * \brief Decodes a texture's image on the job system while the game keeps
+   * running, and uploads it from a later TextureManager::tick(). Textures
+   * that were already added are left as they are.
+   * \return The texture, which is empty until it is resident.
+   */
+  Texture* preload(const request_t& request);
+
+  /**
+   * \brief Preloads textures, then waits until all of them are resident.
+   */
+  void load(const std::vector<request_t>& requests);
+
+  /**
+   * \return Whether or not a texture was added and its image uploaded.
+   */
+  bool isResident(const std::string& name) const;
+
+  /**
+   * \brief Ticks the textures' animations, and uploads preloaded images.
+   */
   void tick();
   void init();
 
@@ -0,0 +1,96 @@
+#pragma once
+#include <array>
+
+#include "SDL.h"
+#include "SDL_atomic.h"
+
+/**
+ * \brief The TripleBuffer class that hands the latest value from a single
+ * producer thread to a single consumer thread without locks. The producer
+ * always has a buffer to write into, the consumer always has a buffer to read
+ * from, and the third one is swapped between them atomically. Values that are
+ * published while the consumer is busy overwrite each other, so the consumer
+ * only ever sees the newest one.
+ * \tparam T The type of the value, reused across writes so it may keep its
+ * allocated storage.
+ */
+template <class T>
+class TripleBuffer final {
+  /**
+   * \brief The bits of the shared state that hold the middle buffer's index.
+   */
+  static const int INDEX_MASK = 0x3;
+
+  /**
+   * \brief The bit of the shared state that is set when the middle buffer
+   * holds a value the consumer has not taken yet.
+   */
+  static const int DIRTY = 0x4;
+
+  std::array<T, 3> buffers_{};
+
+  /**
+   * \brief The middle buffer's index and the dirty bit, only ever exchanged
+   * as a whole.
+   */
+  SDL_atomic_t middle_{};
+
+  /**
+   * \brief The index of the buffer owned by the producer.
+   */
+  int write_ = 0;
+
+  /**
+   * \brief The index of the buffer owned by the consumer.
+   */
+  int read_ = 1;
+
+ public:
+  TripleBuffer() { SDL_AtomicSet(&middle_, 2); }
+  ~TripleBuffer() = default;
+  TripleBuffer(const TripleBuffer&) = delete;             // Copy Constructor
+  TripleBuffer(TripleBuffer&&) = delete;                  // Move Constructor
+  TripleBuffer& operator=(const TripleBuffer&) = delete;  // Assignment Operator
+  TripleBuffer& operator=(TripleBuffer&&) = delete;       // Move Operator
+
+  /**
+   * \brief Get the buffer the producer writes the next value into.
+   * \note Must only be called from the producer thread.
+   * \return The producer's buffer, which still holds an older value.
+   */
+  T& getWriteBuffer() { return buffers_[static_cast<size_t>(write_)]; }
+
+  /**
+   * \brief Publishes the producer's buffer, replacing any value the consumer
+   * has not taken yet.
+   * \note Must only be called from the producer thread.
+   */
+  void publish() {
+    const auto previous = SDL_AtomicSet(&middle_, write_ | DIRTY);
+    write_ = previous & INDEX_MASK;
+  }
+
+  /**
+   * \brief Takes the newest published value, if there is any.
+   * \note Must only be called from the consumer thread.
+   * \return Whether or not a new value was taken into the consumer's buffer.
+   */
+  bool update() {
+    if ((SDL_AtomicGet(&middle_) & DIRTY) == 0) return false;
+
+    // A value published in between is taken as well, as the flag is only
+    // cleared by this exchange
+    const auto previous = SDL_AtomicSet(&middle_, read_);
+    read_ = previous & INDEX_MASK;
+    return true;
+  }
+
+  /**
+   * \brief Get the value taken by the last successful TripleBuffer::update().
+   * \note Must only be called from the consumer thread.
+   * \return The consumer's buffer.
+   */
+  const T& getReadBuffer() const {
+    return buffers_[static_cast<size_t>(read_)];
+  }
+};
@@ -0,0 +1,157 @@
+#pragma once
+#include <functional>
+#include <vector>
+
+#include "SDL.h"
+#include "SlotMap.h"
+#include "System.h"
+
+class GameObject;
+
+/**
+ * \brief How a tween's progress is shaped over its duration.
+ */
+enum class Easing : Uint8 {
+  LINEAR,
+  QUAD_IN,
+  QUAD_OUT,
+  QUAD_IN_OUT,
+  CUBIC_IN,
+  CUBIC_OUT,
+  CUBIC_IN_OUT,
+  SINE_IN_OUT,
+  BACK_OUT,
+  BOUNCE_OUT
+};
+
+/**
+ * \brief What a tween writes its value to.
+ */
+enum class TweenTarget : Uint8 {
+  /**
+   * \brief Nothing, which makes the tween a timer.
+   */
+  NONE,
+  /**
+   * \brief A float, which must outlive the tween or cancel it.
+   */
+  VALUE,
+  POSITION_X,
+  POSITION_Y,
+  SCALE_X,
+  SCALE_Y,
+  ROTATION,
+  /**
+   * \brief The alpha modulation of the game object's texture, from 0 to 255,
+   * which every user of the texture shares.
+   */
+  ALPHA
+};
+
+/**
+ * \brief The TweenSystem class that animates values and game object
+ * properties over time, and runs timers. Every active tween is stored as a
+ * column per field, so a step advances all of them in a few linear loops
+ * instead of a virtual call per animated object. Each scene has one.
+ */
+class TweenSystem final : public System {
+ public:
+  typedef SlotMap<Uint32>::handle_t handle_t;
+
+ private:
+  std::vector<float> elapsed_;
+  std::vector<float> duration_;
+  std::vector<float> progress_;
+  std::vector<float> from_;
+  std::vector<float> to_;
+  std::vector<Easing> easing_;
+  std::vector<TweenTarget> kind_;
+  std::vector<void*> target_;
+  std::vector<std::function<void()>> onComplete_;
+  std::vector<handle_t> handles_;
+
+  /**
+   * \brief The index of every tween in the columns, by handle.
+   */
+  SlotMap<Uint32> slots_;
+
+  /**
+   * \brief The tweens that finished in the current step, and their callbacks.
+   */
+  std::vector<Uint32> finished_;
+  std::vector<std::function<void()>> completed_;
+
+  handle_t add(TweenTarget kind, void* target, float from, float to,
+               float seconds, Easing easing, std::function<void()> onComplete);
+
+  /**
+   * \brief Removes a tween by moving the last one into its place.
+   */
+  void remove(Uint32 index);
+
+  static float read(TweenTarget kind, void* target);
+  static void write(TweenTarget kind, void* target, float value);
+
+ public:
+  /**
+   * \brief Animates a float from its current value.
+   * \param value The float, which must outlive the tween or cancel it.
+   * \param to The value it ends at.
+   * \param seconds How long the animation lasts.
+   * \param onComplete Called once it ends, unless cancelled.
+   */
+  handle_t to(float* value, float to, float seconds,
+              Easing easing = Easing::LINEAR,
+              std::function<void()> onComplete = nullptr);
+
+  /**
+   * \brief Animates a property of a game object from its current value, the
+   * tween is cancelled when the game object is deleted.
+   * \param target The property, anything but TweenTarget::NONE and
+   * TweenTarget::VALUE.
+   */
+  handle_t to(GameObject* gameObject, TweenTarget target, float to,
+              float seconds, Easing easing = Easing::LINEAR,
+              std::function<void()> onComplete = nullptr);
+
+  /**
+   * \brief Calls a function once an amount of time has passed.
+   */
+  handle_t after(float seconds, std::function<void()> callback);
+
+  /**
+   * \brief Stops a tween where it is, without calling its callback.
+   * \return Whether or not it was still active.
+   */
+  bool cancel(const handle_t& handle);
+
+  /**
+   * \brief Stops every tween animating a game object.
+   */
+  void cancel(const GameObject* gameObject);
+
+  bool isActive(const handle_t& handle) const;
+
+  /**
+   * \brief Stops every tween, without calling their callbacks.
+   */
+  void clear();
+
+  /**
+   * \return The amount of active tweens and timers.
+   */
+  size_t size() const;
+
+  /**
+   * \brief Advances every tween, then calls the callbacks of the ones that
+   * ended, which may start or cancel tweens.
+   */
+  void update(World& world, double step) override;
+
+  /**
+   * \brief Shapes a progress.
+   * \param t The progress, from 0 to 1.
+   * \return The eased progress, 0 at the start and 1 at the end.
+   */
+  static float ease(Easing easing, float t);
+};
@@ -0,0 +1,166 @@
+#include "World.h"
+
+#include <string>
+
+#include "SnowShooterError.h"
+
+World::Archetype::Archetype(const World::mask_t mask)
+    : mask_(mask), columnOf_(MAX_COMPONENTS, -1) {
+  for (size_t type = 0; type < MAX_COMPONENTS; ++type) {
+    if ((mask & (mask_t{1} << type)) == 0) continue;
+
+    columnOf_[type] = static_cast<int>(types_.size());
+    types_.push_back(type);
+    columns_.emplace_back();
+  }
+}
+
+World::World() = default;
+
+World::~World() {
+  for (auto* archetype : archetypes_) delete archetype;
+}
+
+std::array<size_t, World::MAX_COMPONENTS>& World::getSizes() {
+  static std::array<size_t, MAX_COMPONENTS> sizes{};
+  return sizes;
+}
+
+size_t World::registerType(const size_t size) {
+  // Types may be first used by systems on different worker threads at once
+  static SDL_SpinLock lock = 0;
+  static size_t count = 0;
+
+  SDL_AtomicLock(&lock);
+  if (count == MAX_COMPONENTS) {
+    SDL_AtomicUnlock(&lock);
+    throw SnowShooterError("Cannot register more than " +
+                           std::to_string(MAX_COMPONENTS) +
+                           " component types.");
+  }
+
+  const auto type = count++;
+  getSizes()[type] = size;
+  SDL_AtomicUnlock(&lock);
+  return type;
+}
+
+World::Archetype* World::getArchetype(const World::mask_t mask) {
+  const auto it = byMask_.find(mask);
+  if (it != byMask_.end()) return it->second;
+
+  auto* archetype = new Archetype(mask);
+  archetypes_.push_back(archetype);
+  byMask_.insert({mask, archetype});
+  return archetype;
+}
+
+size_t World::append(World::Archetype* archetype,
+                     const World::entity_t& entity) {
+  const auto& sizes = getSizes();
+  for (size_t i = 0; i < archetype->types_.size(); ++i) {
+    auto& column = archetype->columns_[i];
+    column.resize(column.size() + sizes[archetype->types_[i]]);
+  }
+
+  archetype->entities_.push_back(entity);
+  return archetype->entities_.size() - 1;
+}
+
+void World::removeRow(World::Archetype* archetype, const size_t row) {
+  const auto& sizes = getSizes();
+  const auto last = archetype->entities_.size() - 1;
+
+  // Keep the columns packed by filling the gap with the last row
+  if (row != last) {
+    for (const auto type : archetype->types_) {
+      memcpy(archetype->at(type, row), archetype->at(type, last), sizes[type]);
+    }
+
+    const auto moved = archetype->entities_[last];
+    archetype->entities_[row] = moved;
+    records_[moved.index].row = row;
+  }
+
+  for (size_t i = 0; i < archetype->types_.size(); ++i) {
+    auto& column = archetype->columns_[i];
+    column.resize(column.size() - sizes[archetype->types_[i]]);
+  }
+  archetype->entities_.pop_back();
+}
+
+void World::move(const World::entity_t& entity, const World::mask_t mask) {
+  auto& record = records_[entity.index];
+  auto* from = record.archetype;
+  auto* to = getArchetype(mask);
+
+  const auto row = append(to, entity);
+  const auto& sizes = getSizes();
+  for (const auto type : to->types_) {
+    if (from->columnOf_[type] < 0) continue;
+    memcpy(to->at(type, row), from->at(type, record.row), sizes[type]);
+  }
+
+  removeRow(from, record.row);
+  record.archetype = to;
+  record.row = row;
+}
+
+World::record_t* World::getRecord(const World::entity_t& entity) {
+  if (entity.index >= records_.size()) return nullptr;
+
+  auto& record = records_[entity.index];
+  if (!record.alive || record.generation != entity.generation) return nullptr;
+  return &record;
+}
+
+void World::destroy(const World::entity_t& entity) {
+  auto* record = getRecord(entity);
+  if (record == nullptr) return;
+
+  removeRow(record->archetype, record->row);
+  record->alive = false;
+  record->archetype = nullptr;
+  ++record->generation;
+  free_.push_back(entity.index);
+  --alive_;
+}
+
+void World::destroyLater(const World::entity_t& entity) {
+  pendingDestroy_.push_back(entity);
+}
+
+void World::flush() {
+  // Stale or repeated handles are skipped by World::destroy
+  for (const auto& entity : pendingDestroy_) destroy(entity);
+  pendingDestroy_.clear();
+}
+
+void World::clear() {
+  for (size_t i = 0; i < records_.size(); ++i) {
+    auto& record = records_[i];
+    if (!record.alive) continue;
+
+    record.alive = false;
+    record.archetype = nullptr;
+    ++record.generation;
+    free_.push_back(static_cast<Uint32>(i));
+  }
+
+  for (auto* archetype : archetypes_) {
+    for (auto& column : archetype->columns_) column.clear();
+    archetype->entities_.clear();
+  }
+
+  pendingDestroy_.clear();
+  alive_ = 0;
+}
+
+bool World::isAlive(const World::entity_t& entity) const {
+  if (entity.index >= records_.size()) return false;
+
+  const auto& record = records_[entity.index];
+  return record.alive && record.generation == entity.generation;
+}
+
+size_t World::size() const { return alive_; }
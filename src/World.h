@@ -0,0 +1,273 @@
+#pragma once
+#include <array>
+#include <cstring>
+#include <map>
+#include <type_traits>
+#include <vector>
+
+#include "SDL.h"
+#include "SDL_atomic.h"
+
+/**
+ * \brief The World class that stores entities and their components by
+ * archetype: every entity with the same set of components lives in the same
+ * table, and each component type is a contiguous column of it. Systems then
+ * sweep the columns linearly with World::each() instead of chasing pointers.
+ *
+ * \note Components must be trivially copyable, as they are moved between
+ * tables as raw bytes. Entities must not be created, destroyed or change their
+ * components while iterating, World::destroyLater() queues the destruction
+ * until World::flush() instead.
+ */
+class World final {
+ public:
+  typedef struct {
+    Uint32 index;
+    Uint32 generation;
+  } entity_t;
+
+  /**
+   * \brief The maximum amount of component types in the whole game.
+   */
+  static const size_t MAX_COMPONENTS = 64;
+
+ private:
+  typedef Uint64 mask_t;
+
+  class Archetype {
+   public:
+    explicit Archetype(mask_t mask);
+
+    mask_t mask_;
+    /**
+     * \brief The component types stored, in ascending order.
+     */
+    std::vector<size_t> types_{};
+    /**
+     * \brief The column of each component type, or -1 if it is not stored.
+     */
+    std::vector<int> columnOf_;
+    std::vector<std::vector<Uint8>> columns_{};
+    std::vector<entity_t> entities_{};
+
+    Uint8* at(size_t type, size_t row) {
+      const auto column = static_cast<size_t>(columnOf_[type]);
+      return columns_[column].data() + row * getSizes()[type];
+    }
+
+    template <class T>
+    T* column() {
+      return reinterpret_cast<T*>(
+          columns_[static_cast<size_t>(columnOf_[typeOf<T>()])].data());
+    }
+
+    size_t size() const { return entities_.size(); }
+  };
+
+  typedef struct {
+    Uint32 generation;
+    bool alive;
+    Archetype* archetype;
+    size_t row;
+  } record_t;
+
+  std::vector<record_t> records_{};
+  std::vector<Uint32> free_{};
+  std::vector<Archetype*> archetypes_{};
+  std::map<mask_t, Archetype*> byMask_{};
+  std::vector<entity_t> pendingDestroy_{};
+  size_t alive_ = 0;
+
+  /**
+   * \brief The size of every registered component type. It never grows, so
+   * systems on worker threads can read it while another type is registered.
+   */
+  static std::array<size_t, MAX_COMPONENTS>& getSizes();
+  static size_t registerType(size_t size);
+
+  template <class T>
+  static size_t typeOf() {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Components must be trivially copyable");
+    static const size_t type = registerType(sizeof(T));
+    return type;
+  }
+
+  template <class... T>
+  static mask_t maskOf() {
+    mask_t mask = 0;
+    const size_t types[] = {0, typeOf<T>()...};
+    for (size_t i = 1; i < sizeof...(T) + 1; ++i) mask |= mask_t{1} << types[i];
+    return mask;
+  }
+
+  Archetype* getArchetype(mask_t mask);
+
+  /**
+   * \brief Appends a zeroed row for the entity into an archetype.
+   * \return The row's index.
+   */
+  size_t append(Archetype* archetype, const entity_t& entity);
+
+  /**
+   * \brief Removes a row by moving the last one into its place.
+   */
+  void removeRow(Archetype* archetype, size_t row);
+
+  /**
+   * \brief Moves an entity into the archetype with the given components,
+   * keeping the ones both archetypes share.
+   */
+  void move(const entity_t& entity, mask_t mask);
+
+  record_t* getRecord(const entity_t& entity);
+
+  template <class T>
+  void write(Archetype* archetype, size_t row, const T& value) {
+    memcpy(archetype->at(typeOf<T>(), row), &value, sizeof(T));
+  }
+
+  template <class... T, class F>
+  static void iterate(Archetype* archetype, F& callback, T*... columns) {
+    const auto size = archetype->size();
+    for (size_t i = 0; i < size; ++i) {
+      callback(archetype->entities_[i], columns[i]...);
+    }
+  }
+
+ public:
+  World();
+  ~World();
+  World(const World&) = delete;             // Copy Constructor
+  World(World&&) = delete;                  // Move Constructor
+  World& operator=(const World&) = delete;  // Assignment Operator
+  World& operator=(World&&) = delete;       // Move Operator
+
+  /**
+   * \brief Creates an entity with the given components.
+   * \param components The initial value of each component.
+   * \return The new entity.
+   */
+  template <class... T>
+  entity_t create(const T&... components) {
+    auto* archetype = getArchetype(maskOf<T...>());
+
+    entity_t entity{};
+    if (free_.empty()) {
+      entity = {static_cast<Uint32>(records_.size()), 0};
+      records_.push_back({0, true, archetype, 0});
+    } else {
+      entity.index = free_.back();
+      free_.pop_back();
+      auto& record = records_[entity.index];
+      entity.generation = record.generation;
+      record.alive = true;
+      record.archetype = archetype;
+    }
+
+    const auto row = append(archetype, entity);
+    records_[entity.index].row = row;
+    const int expand[] = {0, (write(archetype, row, components), 0)...};
+    static_cast<void>(expand);
+
+    ++alive_;
+    return entity;
+  }
+
+  /**
+   * \brief Destroys an entity right away, its handle becomes stale.
+   */
+  void destroy(const entity_t& entity);
+
+  /**
+   * \brief Queues an entity to be destroyed on the next World::flush(), so it
+   * can be called while iterating.
+   */
+  void destroyLater(const entity_t& entity);
+
+  /**
+   * \brief Destroys the entities queued by World::destroyLater().
+   */
+  void flush();
+
+  /**
+   * \brief Destroys every entity.
+   */
+  void clear();
+
+  /**
+   * \return Whether or not the entity exists, false for stale handles.
+   */
+  bool isAlive(const entity_t& entity) const;
+
+  /**
+   * \return The amount of entities alive.
+   */
+  size_t size() const;
+
+  /**
+   * \brief Sets a component of an entity, adding it if it did not have it.
+   * \param entity The entity to modify.
+   * \param value The component's value.
+   */
+  template <class T>
+  void set(const entity_t& entity, const T& value) {
+    auto* record = getRecord(entity);
+    if (record == nullptr) return;
+
+    const auto bit = mask_t{1} << typeOf<T>();
+    if ((record->archetype->mask_ & bit) == 0) {
+      move(entity, record->archetype->mask_ | bit);
+    }
+
+    write(record->archetype, record->row, value);
+  }
+
+  /**
+   * \brief Removes a component from an entity.
+   * \param entity The entity to modify.
+   */
+  template <class T>
+  void remove(const entity_t& entity) {
+    auto* record = getRecord(entity);
+    if (record == nullptr) return;
+
+    const auto bit = mask_t{1} << typeOf<T>();
+    if ((record->archetype->mask_ & bit) != 0) {
+      move(entity, record->archetype->mask_ & ~bit);
+    }
+  }
+
+  /**
+   * \brief Get a component of an entity.
+   * \return The component, which moves when the entity's components change,
+   * or nullptr if the entity does not have it or is stale.
+   */
+  template <class T>
+  T* get(const entity_t& entity) {
+    auto* record = getRecord(entity);
+    if (record == nullptr) return nullptr;
+
+    const auto type = typeOf<T>();
+    if ((record->archetype->mask_ & (mask_t{1} << type)) == 0) return nullptr;
+    return reinterpret_cast<T*>(record->archetype->at(type, record->row));
+  }
+
+  /**
+   * \brief Calls a function for every entity that has all of the given
+   * components, sweeping each archetype's columns in order.
+   * \param callback A function taking the entity and a reference to each
+   * component, in the same order as the template arguments.
+   */
+  template <class... T, class F>
+  void each(F callback) {
+    const auto mask = maskOf<T...>();
+    for (auto* archetype : archetypes_) {
+      if ((archetype->mask_ & mask) != mask || archetype->size() == 0) {
+        continue;
+      }
+
+      iterate(archetype, callback, archetype->template column<T>()...);
+    }
+  }
+};
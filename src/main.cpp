@@ -1,12 +1,17 @@
+#include <cstring>
 #include <iostream>
+#include <string>
 
 #include "FontManager.h"
 #include "Game.h"
 #include "GameManager.h"
 #include "Input.h"
+#include "JobSystem.h"
+#include "Profiler.h"
 #include "SDL.h"
 #include "SDLAudioManager.h"
 #include "Server.h"
+#include "SnowShooterError.h"
 #include "TextureManager.h"
 
 #undef main
@@ -17,22 +22,59 @@ int main(int argc, char** argv) {
                  _CRTDBG_LEAK_CHECK_DF);  // Check Memory Leaks
 #endif
   try {
-    if (argc == 2 && strcmp(argv[1], "server") == 0) {
+    auto status = 0;
+    if (argc >= 2 && strcmp(argv[1], "server") == 0) {
+      for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "--lockstep") == 0) {
+          Server::setLockstep(true);
+        } else {
+          Server::setPort(static_cast<Uint16>(atoi(argv[i])));
+        }
+      }
       const auto server = Server::getInstance();
       server->run();
       delete server;
     } else {
+      // Created before the job workers, which name their threads on start
+      Profiler::setThreadName("main");
+      std::string trace;
+      for (int i = 1; i < argc; ++i) {
+        const std::string option = argv[i];
+        if (option == "--headless") {
+          Game::setHeadless(true);
+        } else if (option == "--renderer=accelerated") {
+          Game::setRenderMode(RenderMode::ACCELERATED);
+        } else if (option == "--renderer=software") {
+          Game::setRenderMode(RenderMode::SOFTWARE);
+        } else if (option == "--renderer=null") {
+          Game::setRenderMode(RenderMode::NONE);
+        } else if (option.compare(0, 9, "--frames=") == 0) {
+          Game::setFrameLimit(static_cast<Uint32>(atoi(argv[i] + 9)));
+        } else if (option.compare(0, 8, "--trace=") == 0) {
+          trace = option.substr(8);
+          Profiler::getInstance()->start();
+        } else {
+          throw SnowShooterError("Unknown option: " + option);
+        }
+      }
       const auto game = Game::getInstance();
       game->load();
-      game->run();
+      // Benchmarks fail when a warmed up frame allocated
+      if (!game->run()) status = 1;
+      if (!trace.empty()) {
+        Profiler::getInstance()->stop();
+        Profiler::getInstance()->save(trace);
+      }
       SDLAudioManager::destroy();
       TextureManager::destroy();
       FontManager::destroy();
       GameManager::destroy();
       Input::destroy();
+      JobSystem::destroy();
+      Profiler::destroy();
       delete game;
     }
-    return 0;
+    return status;
   } catch (std::exception& e) {
     std::cerr << e.what();
     return 1;
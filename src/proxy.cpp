@@ -0,0 +1,99 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "Constants.h"
+#include "NetworkProxy.h"
+
+#undef main
+
+namespace {
+void usage() {
+  std::cerr
+      << "Usage: snowshooter-proxy [options]\n"
+         "  --listen PORT        Port the clients connect to (default "
+      << SERVER_PORT
+      << ")\n"
+         "  --target HOST:PORT   Address of `snowshooter server` (default "
+         "localhost:"
+      << SERVER_PORT + 1
+      << ")\n"
+         "  --latency MS         One-way delay added to every chunk\n"
+         "  --jitter MS          Maximum random delay added on top\n"
+         "  --loss RATIO         Probability of losing a chunk, from 0 to 1\n"
+         "  --retransmit MS      Delay before a lost chunk is resent (200)\n"
+         "  --reorder RATIO      Probability of reordering a chunk\n"
+         "  --reorder-gap MS     Time a reordered chunk is held back (20)\n"
+         "  --bandwidth BYTES    Link capacity in bytes per second\n"
+         "  --seed N             Seed for repeatable runs (1)\n"
+         "  --duration MS        Exit after this long, 0 runs forever (0)\n";
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  NetworkProxy::settings_t settings{0, 0, 0.0, 200, 0.0, 20, 0};
+  auto listen = static_cast<Uint16>(SERVER_PORT);
+  std::string host = "localhost";
+  auto targetPort = static_cast<Uint16>(SERVER_PORT + 1);
+  Uint32 seed = 1;
+  Uint32 duration = 0;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string option = argv[i];
+    if (option == "--help") {
+      usage();
+      return 0;
+    }
+
+    if (i + 1 >= argc) {
+      usage();
+      return 1;
+    }
+
+    const std::string value = argv[++i];
+    const auto number =
+        static_cast<Uint32>(strtoul(value.c_str(), nullptr, 10));
+    if (option == "--listen") {
+      listen = static_cast<Uint16>(number);
+    } else if (option == "--target") {
+      const auto colon = value.rfind(':');
+      host = value.substr(0, colon);
+      if (colon != std::string::npos) {
+        targetPort = static_cast<Uint16>(
+            strtoul(value.substr(colon + 1).c_str(), nullptr, 10));
+      }
+    } else if (option == "--latency") {
+      settings.latency = number;
+    } else if (option == "--jitter") {
+      settings.jitter = number;
+    } else if (option == "--loss") {
+      settings.loss = strtod(value.c_str(), nullptr);
+    } else if (option == "--retransmit") {
+      settings.retransmit = number;
+    } else if (option == "--reorder") {
+      settings.reorder = strtod(value.c_str(), nullptr);
+    } else if (option == "--reorder-gap") {
+      settings.reorderGap = number;
+    } else if (option == "--bandwidth") {
+      settings.bandwidth = number;
+    } else if (option == "--seed") {
+      seed = number;
+    } else if (option == "--duration") {
+      duration = number;
+    } else {
+      usage();
+      return 1;
+    }
+  }
+
+  try {
+    NetworkProxy proxy(settings, seed);
+    proxy.open(listen, host, targetPort);
+    proxy.run(duration);
+    return 0;
+  } catch (std::exception& e) {
+    std::cerr << e.what();
+    return 1;
+  }
+}